@@ -0,0 +1,383 @@
+/*
+ * SDLX, a SDL graphics library for CS students.
+ * Copyright (C) 2017, Seth Kasmann, Yihsiang Liow
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*****************************************************************************
+
+    Audio benchmark
+
+    Measures what sound costs, headless:
+
+        load/...     making a Sound from one second of PCM samples in
+                     several formats, with fast and best resampling
+        decode/...   decoding a sound file to the device format
+        music/...    opening a Music stream, and decoding all of an OGG
+        play/...     one Sound::play() call, with every voice busy most of
+                     the time so voice stealing is included
+        mix/...      one mixing callback with 8, 32, 128 and 256 voices
+                     playing, for SDL_mixer and the NativeMixer
+
+    Every row has the same columns:
+
+        count        measurements taken
+        mean_us, p50_us, p95_us, max_us
+        rate         load, decode: MB of samples made per second
+                     music/decode: seconds of music decoded per second
+                     play: calls per second
+                     mix: percent of a buffer's duration spent mixing
+
+    n is the frequency for load, the number of voices for play and mix
+    and the length in seconds for music/decode.
+
+    A play or mix case that cannot run, because the device or the native
+    mixer did not open, is not left out: its row has a count of 0, the
+    error is printed and the program exits with status 1.
+
+    Run it with
+
+        make audio
+
+    which uses SDL_AUDIODRIVER=dummy, so it runs without a sound card.
+    SDL_AUDIODRIVER=disk works too. Run from the top of the repository so
+    sounds/ is found.
+
+*****************************************************************************/
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "bench.h"
+#include "sdlx.h"
+
+using namespace sdlx;
+
+namespace {
+
+    // Samples of noise at half volume.
+    std::vector<uint8_t> noise(int frequency, uint16_t format, int channels,
+                               double seconds)
+    {
+        const int samples = static_cast<int>(frequency * seconds) * channels;
+        const int size = SDL_AUDIO_BITSIZE(format) / 8;
+        std::vector<uint8_t> pcm(samples * size);
+        for (int i = 0; i < samples; ++i)
+        {
+            const float v = (rand() / float(RAND_MAX) - 0.5f);
+            uint8_t* p = &pcm[i * size];
+            if (format == AUDIO_U8)
+                *p = static_cast<uint8_t>(128 + v * 127);
+            else if (format == AUDIO_S16SYS)
+            {
+                int16_t s = static_cast<int16_t>(v * 32767);
+                std::memcpy(p, &s, sizeof(s));
+            }
+            else if (format == AUDIO_S32SYS)
+            {
+                int32_t s = static_cast<int32_t>(v * 2147483647.0);
+                std::memcpy(p, &s, sizeof(s));
+            }
+            else
+                std::memcpy(p, &v, sizeof(v));
+        }
+        return pcm;
+    }
+
+    // Noise in the format the device was opened with.
+    std::vector<uint8_t> device_noise(double seconds)
+    {
+        const AudioConfig s = context().audio().spec();
+        return noise(s.frequency, s.format, s.channels, seconds);
+    }
+
+    void open_device(bool native, Resample resample)
+    {
+        AudioDevice& device = context().audio();
+        device.close();
+        AudioConfig config;
+        config.voices = 256;
+        config.native = native;
+        config.resample = resample;
+        device.configure(config);
+        device.acquire();
+    }
+
+    void close_device()
+    {
+        context().audio().close();
+    }
+
+    bench::Result summarize(const std::string& name, int n,
+                            std::vector<double>& us, double rate)
+    {
+        double total = 0.0;
+        for (size_t i = 0; i < us.size(); ++i)
+            total += us[i];
+
+        bench::Result r;
+        r.name = name;
+        r.n = n;
+        r.metrics.push_back(std::make_pair("count", double(us.size())));
+        r.metrics.push_back(std::make_pair("mean_us", us.empty() ? 0.0 : total / us.size()));
+        r.metrics.push_back(std::make_pair("p50_us", bench::percentile(us, 50)));
+        r.metrics.push_back(std::make_pair("p95_us", bench::percentile(us, 95)));
+        r.metrics.push_back(std::make_pair("max_us", bench::percentile(us, 100)));
+        r.metrics.push_back(std::make_pair("rate", rate));
+        return r;
+    }
+
+    double mean(const std::vector<double>& v)
+    {
+        double total = 0.0;
+        for (size_t i = 0; i < v.size(); ++i)
+            total += v[i];
+        return v.empty() ? 0.0 : total / v.size();
+    }
+
+    // True if the device opened as asked. Otherwise adds an empty row for
+    // the case, so it shows up as skipped, and closes the device.
+    bool opened(std::vector<bench::Result>& results, const std::string& name,
+                int n, bool native, bool& failed)
+    {
+        AudioDevice& device = context().audio();
+        if (device.is_open() && (!native || device.native().is_open()))
+            return true;
+
+        std::cerr << name << " " << n << ": skipped, the "
+                  << (device.is_open() ? "native mixer" : "audio device")
+                  << " did not open\n";
+        std::vector<double> none;
+        results.push_back(summarize(name, n, none, 0.0));
+        failed = true;
+        close_device();
+        return false;
+    }
+
+    //------------------------------------------------------------------------
+    // Benchmarks
+    //------------------------------------------------------------------------
+
+    struct Format
+    {
+        const char* name;
+        int frequency;
+        uint16_t format;
+        int channels;
+    };
+
+    void load(std::vector<bench::Result>& results, int repeats)
+    {
+        const Format FORMATS[] = {
+            { "u8 mono", 22050, AUDIO_U8, 1 },
+            { "s16 mono", 22050, AUDIO_S16SYS, 1 },
+            { "s16 stereo", 44100, AUDIO_S16SYS, 2 },
+            { "s32 stereo", 48000, AUDIO_S32SYS, 2 },
+            { "f32 stereo", 48000, AUDIO_F32SYS, 2 },
+        };
+        const Resample QUALITY[] = { RESAMPLE_FAST, RESAMPLE_BEST };
+        const char* QUALITY_NAMES[] = { "fast", "best" };
+
+        for (int q = 0; q < 2; ++q)
+        {
+            open_device(false, QUALITY[q]);
+            const AudioConfig spec = context().audio().spec();
+            for (int f = 0; f < 5; ++f)
+            {
+                const Format& fm = FORMATS[f];
+                std::vector<uint8_t> pcm = noise(fm.frequency, fm.format, fm.channels, 1.0);
+                std::vector<double> us;
+                for (int i = 0; i < repeats; ++i)
+                {
+                    const double start = bench::now_ns();
+                    Sound sound(pcm.data(), pcm.size(), fm.frequency, fm.format, fm.channels);
+                    us.push_back((bench::now_ns() - start) / 1e3);
+                }
+                // One second of samples in the device format.
+                const double bytes = spec.frequency * spec.channels
+                                     * (SDL_AUDIO_BITSIZE(spec.format) / 8);
+                const double rate = bytes / (1 << 20) / (mean(us) / 1e6);
+                results.push_back(summarize(std::string("load/") + fm.name + "/"
+                                            + QUALITY_NAMES[q], fm.frequency, us, rate));
+            }
+            close_device();
+        }
+    }
+
+    void decode(std::vector<bench::Result>& results, int repeats)
+    {
+        const char* FILES[] = { "sounds/laser.wav", "sounds/explosion.wav" };
+        open_device(false, RESAMPLE_DEFAULT);
+        const AudioConfig spec = context().audio().spec();
+        for (int f = 0; f < 2; ++f)
+        {
+            std::vector<double> us;
+            size_t bytes = 0;
+            for (int i = 0; i < repeats; ++i)
+            {
+                std::vector<uint8_t> pcm;
+                const double start = bench::now_ns();
+                decode_pcm(FILES[f], spec, pcm);
+                us.push_back((bench::now_ns() - start) / 1e3);
+                bytes = pcm.size();
+            }
+            const double rate = bytes / double(1 << 20) / (mean(us) / 1e6);
+            results.push_back(summarize(std::string("decode/") + FILES[f], 0, us, rate));
+        }
+        close_device();
+    }
+
+    void music(std::vector<bench::Result>& results, int repeats)
+    {
+        const char* TRACK = "sounds/GameLoop.ogg";
+        open_device(false, RESAMPLE_DEFAULT);
+        const AudioConfig spec = context().audio().spec();
+
+        std::vector<double> us;
+        for (int i = 0; i < repeats; ++i)
+        {
+            const double start = bench::now_ns();
+            Music music(TRACK);
+            us.push_back((bench::now_ns() - start) / 1e3);
+        }
+        results.push_back(summarize("music/open", 0, us, 0.0));
+
+        us.clear();
+        double seconds = 0.0;
+        for (int i = 0; i < repeats; ++i)
+        {
+            std::vector<uint8_t> pcm;
+            const double start = bench::now_ns();
+            decode_pcm(TRACK, spec, pcm);
+            us.push_back((bench::now_ns() - start) / 1e3);
+            seconds = pcm.size() / double(spec.frequency * spec.channels
+                                          * (SDL_AUDIO_BITSIZE(spec.format) / 8));
+        }
+        const double rate = seconds / (mean(us) / 1e6);
+        results.push_back(summarize("music/decode", static_cast<int>(seconds + 0.5), us, rate));
+        close_device();
+    }
+
+    void play(std::vector<bench::Result>& results, bool native, int calls,
+              bool& failed)
+    {
+        const char* name = native ? "play/native" : "play/sdl_mixer";
+        open_device(native, RESAMPLE_DEFAULT);
+        if (!opened(results, name, 256, native, failed))
+            return;
+        std::vector<uint8_t> pcm = device_noise(2.0);
+        const AudioConfig spec = context().audio().spec();
+        std::vector<double> us;
+        {
+            Sound sound(pcm.data(), pcm.size(), spec.frequency, spec.format, spec.channels);
+            sound.set_coalesce(0);
+            sound.set_limit(0);
+            for (int i = 0; i < calls; ++i)
+            {
+                const double start = bench::now_ns();
+                sound.play();
+                us.push_back((bench::now_ns() - start) / 1e3);
+            }
+        }
+        const double rate = 1e6 / mean(us);
+        results.push_back(summarize(name, 256, us, rate));
+        close_device();
+    }
+
+    void mix(std::vector<bench::Result>& results, bool native, int voices, int ms,
+             bool& failed)
+    {
+        const char* name = native ? "mix/native" : "mix/sdl_mixer";
+        open_device(native, RESAMPLE_DEFAULT);
+        AudioDevice& device = context().audio();
+        if (!opened(results, name, voices, native, failed))
+            return;
+        // SDL_mixer only times its callbacks when asked to.
+        device.set_timing(!native);
+        std::vector<uint8_t> pcm = device_noise(ms / 1000.0 + 2.0);
+        const AudioConfig spec = device.spec();
+        std::vector<double> us;
+        {
+            Sound sound(pcm.data(), pcm.size(), spec.frequency, spec.format, spec.channels);
+            sound.set_coalesce(0);
+            sound.set_limit(0);
+            sound.set_volume(MIX_MAX_VOLUME / 8);
+            for (int i = 0; i < voices; ++i)
+                sound.play();
+            SDL_Delay(200);
+
+            if (native)
+            {
+                // The native mixer keeps no history, so watch every callback.
+                uint32_t last = device.native().stats().callbacks;
+                const double end = bench::now_ns() + ms * 1e6;
+                while (bench::now_ns() < end)
+                {
+                    MixerStats s = device.native().stats();
+                    if (s.callbacks != last)
+                    {
+                        us.push_back(s.mix_ms * 1e3);
+                        last = s.callbacks;
+                    }
+                    SDL_Delay(1);
+                }
+            }
+            else
+            {
+                device.reset_stats();
+                SDL_Delay(ms);
+                std::vector<AudioSample> history;
+                device.history(history);
+                for (size_t i = 0; i < history.size(); ++i)
+                    if (history[i].voices > 0)
+                        us.push_back(history[i].mix_ms * 1e3);
+            }
+        }
+
+        const double buffer_us = 1e6 * spec.chunk / spec.frequency;
+        const double rate = 100.0 * mean(us) / buffer_us;
+        results.push_back(summarize(name, voices, us, rate));
+        device.set_timing(false);
+        close_device();
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    bench::Options options = bench::parse_options(argc, argv);
+    const int repeats = options.quick ? 5 : 50;
+    const int calls = options.quick ? 500 : 5000;
+    const int ms = options.quick ? 500 : 3000;
+
+    srand(245);
+    std::vector<bench::Result> results;
+    load(results, repeats);
+    decode(results, repeats);
+    music(results, options.quick ? 1 : 5);
+
+    const int VOICES[] = { 8, 32, 128, 256 };
+    bool failed = false;
+    for (int native = 0; native < 2; ++native)
+    {
+        play(results, native != 0, calls, failed);
+        for (int v = 0; v < 4; ++v)
+            mix(results, native != 0, VOICES[v], ms, failed);
+    }
+
+    context().print_startup(std::cerr);
+    const int status = bench::write_results(options, results);
+    return failed ? 1 : status;
+}
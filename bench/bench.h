@@ -0,0 +1,174 @@
+/*
+ * SDLX, a SDL graphics library for CS students.
+ * Copyright (C) 2017, Seth Kasmann, Yihsiang Liow
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*****************************************************************************
+
+    Helpers shared by the benchmark programs in bench/.
+
+    Every benchmark produces a list of Results. A Result is one row: the
+    name of what was measured, the size it was measured at (batch size,
+    number of sprites, number of voices ...) and any number of named
+    metrics. Results are written as CSV, JSON or both.
+
+    Command line options understood by every benchmark:
+
+        --csv FILE    write CSV to FILE
+        --json FILE   write JSON to FILE
+        --quick       shorter runs, for smoke testing
+
+    With neither --csv nor --json, CSV is written to stdout.
+
+*****************************************************************************/
+
+namespace bench {
+
+    typedef std::vector<std::pair<std::string, double> > Metrics;
+
+    struct Result
+    {
+        std::string name;
+        int n;
+        Metrics metrics;
+    };
+
+    struct Options
+    {
+        Options()
+            : quick(false)
+        {}
+        bool quick;
+        std::string csv;
+        std::string json;
+    };
+
+    inline Options parse_options(int argc, char* argv[])
+    {
+        Options o;
+        for (int i = 1; i < argc; ++i)
+        {
+            if (std::strcmp(argv[i], "--quick") == 0)
+                o.quick = true;
+            else if (std::strcmp(argv[i], "--csv") == 0 && i + 1 < argc)
+                o.csv = argv[++i];
+            else if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+                o.json = argv[++i];
+            else
+                std::cerr << "Unknown option " << argv[i] << '\n';
+        }
+        return o;
+    }
+
+    inline double now_ns()
+    {
+        using namespace std::chrono;
+        return duration_cast<nanoseconds>(
+            steady_clock::now().time_since_epoch()).count();
+    }
+
+    // The p-th percentile (0 .. 100) of v, nearest-rank. v is reordered.
+    inline double percentile(std::vector<double>& v, double p)
+    {
+        if (v.empty())
+            return 0.0;
+        size_t k = static_cast<size_t>(p / 100.0 * (v.size() - 1) + 0.5);
+        std::nth_element(v.begin(), v.begin() + k, v.end());
+        return v[k];
+    }
+
+    inline void write_csv(std::ostream& out, const std::vector<Result>& results)
+    {
+        if (results.empty())
+            return;
+        out << "name,n";
+        for (size_t i = 0; i < results[0].metrics.size(); ++i)
+            out << ',' << results[0].metrics[i].first;
+        out << '\n';
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            // Names such as "put_point(x,y,Color)" contain commas.
+            out << '"' << results[i].name << "\"," << results[i].n;
+            for (size_t j = 0; j < results[i].metrics.size(); ++j)
+                out << ',' << results[i].metrics[j].second;
+            out << '\n';
+        }
+    }
+
+    inline void write_json(std::ostream& out, const std::vector<Result>& results)
+    {
+        out << "[\n";
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            out << "  {\"name\": \"" << results[i].name << "\", \"n\": "
+                << results[i].n;
+            for (size_t j = 0; j < results[i].metrics.size(); ++j)
+                out << ", \"" << results[i].metrics[j].first << "\": "
+                    << results[i].metrics[j].second;
+            out << (i + 1 < results.size() ? "},\n" : "}\n");
+        }
+        out << "]\n";
+    }
+
+    // Writes results as asked for by the options. Returns the exit status
+    // for main().
+    inline int write_results(const Options& o, const std::vector<Result>& results)
+    {
+        if (o.csv.empty() && o.json.empty())
+        {
+            write_csv(std::cout, results);
+            return 0;
+        }
+
+        int status = 0;
+        if (!o.csv.empty())
+        {
+            std::ofstream out(o.csv.c_str());
+            write_csv(out, results);
+            if (!out)
+            {
+                std::cerr << "Cannot write " << o.csv << '\n';
+                status = 1;
+            }
+        }
+        if (!o.json.empty())
+        {
+            std::ofstream out(o.json.c_str());
+            write_json(out, results);
+            if (!out)
+            {
+                std::cerr << "Cannot write " << o.json << '\n';
+                status = 1;
+            }
+        }
+        return status;
+    }
+}
+
+#endif
@@ -0,0 +1,84 @@
+/*
+ * SDLX, a SDL graphics library for CS students.
+ * Copyright (C) 2017, Seth Kasmann, Yihsiang Liow
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*****************************************************************************
+
+    Audio latency self-test
+
+    Opens the audio device with several chunk sizes and sample rates and
+    runs AudioDevice::self_test() on each, reporting:
+
+        buffer_ms     one mixing buffer
+        output_ms     the estimated output latency
+        loopback_ms   measured from play() to the mixed output, plus one
+                      buffer
+        period_ms     average time between mixing callbacks
+        jitter_ms     average distance from that period
+
+    Run it with
+
+        make latency
+
+    which uses SDL_AUDIODRIVER=dummy, so it runs without a sound card. Set
+    SDL_AUDIODRIVER=disk to have SDL write the output to sdlaudio.raw, or
+    leave it unset to test the real device.
+
+*****************************************************************************/
+
+#include <vector>
+#include "bench.h"
+#include "sdlx.h"
+
+using namespace sdlx;
+
+int main(int argc, char* argv[])
+{
+    bench::Options options = bench::parse_options(argc, argv);
+    const int clicks = options.quick ? 4 : 16;
+
+    const int RATES[] = { 44100, 48000 };
+    const int CHUNKS[] = { 128, 256, 512, 1024, 2048 };
+
+    AudioDevice& device = context().audio();
+    std::vector<bench::Result> results;
+    for (int r = 0; r < 2; ++r)
+    {
+        for (int c = 0; c < 5; ++c)
+        {
+            AudioConfig config;
+            config.frequency = RATES[r];
+            config.chunk = CHUNKS[c];
+            device.configure(config);
+
+            AudioLatency l = device.self_test(clicks);
+
+            bench::Result result;
+            result.name = RATES[r] == 44100 ? "44100Hz" : "48000Hz";
+            result.n = CHUNKS[c];
+            result.metrics.push_back(std::make_pair("buffer_ms", l.buffer_ms));
+            result.metrics.push_back(std::make_pair("output_ms", l.output_ms));
+            result.metrics.push_back(std::make_pair("loopback_ms", l.loopback_ms));
+            result.metrics.push_back(std::make_pair("period_ms", l.period_ms));
+            result.metrics.push_back(std::make_pair("jitter_ms", l.jitter_ms));
+            results.push_back(result);
+        }
+    }
+
+    context().print_startup(std::cerr);
+    return bench::write_results(options, results);
+}
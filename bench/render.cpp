@@ -0,0 +1,264 @@
+/*
+ * SDLX, a SDL graphics library for CS students.
+ * Copyright (C) 2017, Seth Kasmann, Yihsiang Liow
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*****************************************************************************
+
+    Render benchmark
+
+    Measures every Window drawing call at several batch sizes and writes one
+    row per (call, batch size) with the median and 95th percentile cost per
+    call, calls per second and primitives per second.
+
+    Drawing goes to an offscreen Window (software renderer into memory), so
+    the numbers do not depend on a GPU or a display. Run it with
+
+        make bench
+
+    which sets SDL_VIDEODRIVER=dummy. Run from the top of the repository so
+    the images/ and fonts/ directories are found.
+
+*****************************************************************************/
+
+#include <cmath>
+#include <cstdlib>
+#include "bench.h"
+#include "sdlx.h"
+
+using namespace sdlx;
+
+namespace {
+
+    const int W = 640;
+    const int H = 480;
+    const int BATCHES[] = { 1, 16, 256, 4096 };
+    const int SEEDS = 1024;   // must be a power of two
+    const int POLY = 8;
+
+    struct Fixture
+    {
+        Point pts[SEEDS];
+        Point poly[POLY];
+        Color color;
+    };
+
+    // Reading back a pixel makes the renderer finish everything it has
+    // queued, so the work of a batch is inside the timed region.
+    void finish(Window& window)
+    {
+        uint32_t pixel;
+        const SDL_Rect r = { 0, 0, 1, 1 };
+        SDL_RenderReadPixels(window.get_renderer(), &r, SDL_PIXELFORMAT_ARGB8888,
+                             &pixel, sizeof(pixel));
+    }
+
+    template <typename F>
+    void measure(std::vector<bench::Result>& results, Window& window,
+                 const std::string& name, int prims, int batch, double min_ns, F f)
+    {
+        f(0);
+        finish(window);
+
+        std::vector<double> rounds;
+        double total = 0.0;
+        while (total < min_ns || rounds.size() < 5)
+        {
+            double start = bench::now_ns();
+            for (int i = 0; i < batch; ++i)
+                f(i);
+            finish(window);
+            double dt = bench::now_ns() - start;
+            total += dt;
+            rounds.push_back(dt / batch);
+        }
+
+        double p50 = bench::percentile(rounds, 50);
+        double p95 = bench::percentile(rounds, 95);
+
+        bench::Result r;
+        r.name = name;
+        r.n = batch;
+        r.metrics.push_back(std::make_pair("ns_per_call", p50));
+        r.metrics.push_back(std::make_pair("ns_per_call_p95", p95));
+        r.metrics.push_back(std::make_pair("calls_per_sec", 1e9 / p50));
+        r.metrics.push_back(std::make_pair("prims_per_sec", prims * 1e9 / p50));
+        results.push_back(r);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    bench::Options options = bench::parse_options(argc, argv);
+    const double min_ns = options.quick ? 20e6 : 200e6;
+
+    Window window(W, H, OFFSCREEN);
+    if (window.get_renderer() == nullptr)
+        return 1;
+
+    Image sprite("images/galaxian/GalaxianAquaAlien.gif", window);
+    Font font("fonts/FreeSans.ttf", 24);
+
+    Fixture fx;
+    srand(245);
+    for (int i = 0; i < SEEDS; ++i)
+    {
+        fx.pts[i].x = rand() % W;
+        fx.pts[i].y = rand() % H;
+    }
+    for (int i = 0; i < POLY; ++i)
+    {
+        double a = 2.0 * M_PI * i / POLY;
+        fx.poly[i].x = W / 2 + static_cast<int>(100 * std::cos(a));
+        fx.poly[i].y = H / 2 + static_cast<int>(100 * std::sin(a));
+    }
+    fx.color = Color(200, 100, 50);
+
+    const Color& c = fx.color;
+    const int M = SEEDS - 1;
+    std::vector<bench::Result> results;
+
+    for (size_t b = 0; b < sizeof(BATCHES) / sizeof(BATCHES[0]); ++b)
+    {
+        const int n = BATCHES[b];
+
+        // Points
+        measure(results, window, "put_point(Point,Color)", 1, n, min_ns,
+            [&](int i) { window.put_point(fx.pts[i & M], c); });
+        measure(results, window, "put_point(Point,rgba)", 1, n, min_ns,
+            [&](int i) { window.put_point(fx.pts[i & M], c.r, c.g, c.b); });
+        measure(results, window, "put_point(x,y,Color)", 1, n, min_ns,
+            [&](int i) { window.put_point(fx.pts[i & M].x, fx.pts[i & M].y, c); });
+        measure(results, window, "put_point(x,y,rgba)", 1, n, min_ns,
+            [&](int i) { window.put_point(fx.pts[i & M].x, fx.pts[i & M].y, c.r, c.g, c.b); });
+
+        // Lines
+        measure(results, window, "put_line(x0,y0,x1,y1,Color)", 1, n, min_ns,
+            [&](int i) { const Point& p = fx.pts[i & M]; const Point& q = fx.pts[(i + 1) & M];
+                         window.put_line(p.x, p.y, q.x, q.y, c); });
+        measure(results, window, "put_line(x0,y0,x1,y1,rgba)", 1, n, min_ns,
+            [&](int i) { const Point& p = fx.pts[i & M]; const Point& q = fx.pts[(i + 1) & M];
+                         window.put_line(p.x, p.y, q.x, q.y, c.r, c.g, c.b); });
+        measure(results, window, "put_line(Point*,size,Color)", POLY - 1, n, min_ns,
+            [&](int i) { window.put_line(fx.poly, POLY, c); });
+        measure(results, window, "put_line(Point*,size,rgba)", POLY - 1, n, min_ns,
+            [&](int i) { window.put_line(fx.poly, POLY, c.r, c.g, c.b); });
+
+        // Circles
+        measure(results, window, "put_circle(x,y,rad,rgba)", 1, n, min_ns,
+            [&](int i) { window.put_circle(fx.pts[i & M].x, fx.pts[i & M].y, 20, c.r, c.g, c.b); });
+        measure(results, window, "put_circle(Circle,Color)", 1, n, min_ns,
+            [&](int i) { Circle cir = { int16_t(fx.pts[i & M].x), int16_t(fx.pts[i & M].y), 20 };
+                         window.put_circle(cir, c); });
+        measure(results, window, "put_circle(x,y,r,Color)", 1, n, min_ns,
+            [&](int i) { window.put_circle(fx.pts[i & M].x, fx.pts[i & M].y, 20, c); });
+        measure(results, window, "put_circle(Circle,rgba)", 1, n, min_ns,
+            [&](int i) { Circle cir = { int16_t(fx.pts[i & M].x), int16_t(fx.pts[i & M].y), 20 };
+                         window.put_circle(cir, c.r, c.g, c.b); });
+        measure(results, window, "put_unfilled_circle(x,y,r,Color)", 1, n, min_ns,
+            [&](int i) { window.put_unfilled_circle(fx.pts[i & M].x, fx.pts[i & M].y, 20, c); });
+        measure(results, window, "put_unfilled_circle(x,y,rad,rgba)", 1, n, min_ns,
+            [&](int i) { window.put_unfilled_circle(fx.pts[i & M].x, fx.pts[i & M].y, 20, c.r, c.g, c.b); });
+        measure(results, window, "put_unfilled_circle(Circle,rgba)", 1, n, min_ns,
+            [&](int i) { Circle cir = { int16_t(fx.pts[i & M].x), int16_t(fx.pts[i & M].y), 20 };
+                         window.put_unfilled_circle(cir, c.r, c.g, c.b); });
+        measure(results, window, "put_unfilled_circle(Circle,Color)", 1, n, min_ns,
+            [&](int i) { Circle cir = { int16_t(fx.pts[i & M].x), int16_t(fx.pts[i & M].y), 20 };
+                         window.put_unfilled_circle(cir, c); });
+
+        // Ellipses
+        measure(results, window, "put_ellipse(x,y,rx,ry,rgba)", 1, n, min_ns,
+            [&](int i) { window.put_ellipse(fx.pts[i & M].x, fx.pts[i & M].y, 30, 15, c.r, c.g, c.b); });
+        measure(results, window, "put_ellipse(Ellipse,Color)", 1, n, min_ns,
+            [&](int i) { Ellipse e = { int16_t(fx.pts[i & M].x), int16_t(fx.pts[i & M].y), 30, 15 };
+                         window.put_ellipse(e, c); });
+        measure(results, window, "put_ellipse(x,y,rx,ry,Color)", 1, n, min_ns,
+            [&](int i) { window.put_ellipse(fx.pts[i & M].x, fx.pts[i & M].y, 30, 15, c); });
+        measure(results, window, "put_ellipse(Ellipse,rgba)", 1, n, min_ns,
+            [&](int i) { Ellipse e = { int16_t(fx.pts[i & M].x), int16_t(fx.pts[i & M].y), 30, 15 };
+                         window.put_ellipse(e, c.r, c.g, c.b); });
+        measure(results, window, "put_unfilled_ellipse(x,y,rx,ry,Color)", 1, n, min_ns,
+            [&](int i) { window.put_unfilled_ellipse(fx.pts[i & M].x, fx.pts[i & M].y, 30, 15, c); });
+        measure(results, window, "put_unfilled_ellipse(x,y,rx,ry,rgba)", 1, n, min_ns,
+            [&](int i) { window.put_unfilled_ellipse(fx.pts[i & M].x, fx.pts[i & M].y, 30, 15, c.r, c.g, c.b); });
+        measure(results, window, "put_unfilled_ellipse(Ellipse,rgba)", 1, n, min_ns,
+            [&](int i) { Ellipse e = { int16_t(fx.pts[i & M].x), int16_t(fx.pts[i & M].y), 30, 15 };
+                         window.put_unfilled_ellipse(e, c.r, c.g, c.b); });
+        measure(results, window, "put_unfilled_ellipse(Ellipse,Color)", 1, n, min_ns,
+            [&](int i) { Ellipse e = { int16_t(fx.pts[i & M].x), int16_t(fx.pts[i & M].y), 30, 15 };
+                         window.put_unfilled_ellipse(e, c); });
+
+        // Images
+        measure(results, window, "put_image(Image,src,dst)", 1, n, min_ns,
+            [&](int i) { Rect src = sprite.get_rect();
+                         Rect dst = { fx.pts[i & M].x, fx.pts[i & M].y, src.w, src.h };
+                         window.put_image(sprite, src, dst); });
+        measure(results, window, "put_image(Image,dst)", 1, n, min_ns,
+            [&](int i) { Rect dst = sprite.get_rect();
+                         dst.x = fx.pts[i & M].x;
+                         dst.y = fx.pts[i & M].y;
+                         window.put_image(sprite, dst); });
+
+        // Rectangles
+        measure(results, window, "put_rect(Rect,rgba)", 1, n, min_ns,
+            [&](int i) { Rect r = { fx.pts[i & M].x, fx.pts[i & M].y, 24, 16 };
+                         window.put_rect(r, c.r, c.g, c.b); });
+        measure(results, window, "put_rect(Rect,Color)", 1, n, min_ns,
+            [&](int i) { Rect r = { fx.pts[i & M].x, fx.pts[i & M].y, 24, 16 };
+                         window.put_rect(r, c); });
+        measure(results, window, "put_rect(x,y,w,h,Color)", 1, n, min_ns,
+            [&](int i) { window.put_rect(fx.pts[i & M].x, fx.pts[i & M].y, 24, 16, c); });
+        measure(results, window, "put_rect(x,y,w,h,rgba)", 1, n, min_ns,
+            [&](int i) { window.put_rect(fx.pts[i & M].x, fx.pts[i & M].y, 24, 16, c.r, c.g, c.b); });
+        measure(results, window, "put_unfilled_rect(x,y,w,h,Color)", 4, n, min_ns,
+            [&](int i) { window.put_unfilled_rect(fx.pts[i & M].x, fx.pts[i & M].y, 24, 16, c); });
+        measure(results, window, "put_unfilled_rect(Rect,Color)", 4, n, min_ns,
+            [&](int i) { Rect r = { fx.pts[i & M].x, fx.pts[i & M].y, 24, 16 };
+                         window.put_unfilled_rect(r, c); });
+        measure(results, window, "put_unfilled_rect(Rect,rgba)", 4, n, min_ns,
+            [&](int i) { Rect r = { fx.pts[i & M].x, fx.pts[i & M].y, 24, 16 };
+                         window.put_unfilled_rect(r, c.r, c.g, c.b); });
+        measure(results, window, "put_unfilled_rect(x,y,w,h,rgba)", 4, n, min_ns,
+            [&](int i) { window.put_unfilled_rect(fx.pts[i & M].x, fx.pts[i & M].y, 24, 16, c.r, c.g, c.b); });
+
+        // Polygons
+        measure(results, window, "put_polygon(Point*,size,Color)", 1, n, min_ns,
+            [&](int i) { window.put_polygon(fx.poly, POLY, c); });
+        measure(results, window, "put_polygon(Point*,size,rgba)", 1, n, min_ns,
+            [&](int i) { window.put_polygon(fx.poly, POLY, c.r, c.g, c.b); });
+        measure(results, window, "put_unfilled_polygon(Point*,size,Color)", POLY, n, min_ns,
+            [&](int i) { window.put_unfilled_polygon(fx.poly, POLY, c); });
+        measure(results, window, "put_unfilled_polygon(Point*,size,rgba)", POLY, n, min_ns,
+            [&](int i) { window.put_unfilled_polygon(fx.poly, POLY, c.r, c.g, c.b); });
+
+        // Text: render the string to a new Image and draw it, the way
+        // fancyhelloworld() does every frame.
+        measure(results, window, "text(Image(text,Font)+put_image)", 1, n, min_ns,
+            [&](int i) { Image text("hello world", font, c, window);
+                         Rect dst = text.get_rect();
+                         dst.x = fx.pts[i & M].x;
+                         dst.y = fx.pts[i & M].y;
+                         window.put_image(text, dst); });
+
+        // Clear and present.
+        measure(results, window, "clear(Color)", 1, n, min_ns,
+            [&](int i) { window.clear(c); });
+        measure(results, window, "draw()", 0, n, min_ns,
+            [&](int i) { window.draw(); });
+    }
+
+    return bench::write_results(options, results);
+}
@@ -0,0 +1,355 @@
+/*
+ * SDLX, a SDL graphics library for CS students.
+ * Copyright (C) 2017, Seth Kasmann, Yihsiang Liow
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*****************************************************************************
+
+    Stress scenarios
+
+    The demos in main.cpp scaled up. Each scenario draws a fixed number of
+    frames into an offscreen Window without any delay and reports the frame
+    time percentiles:
+
+    * fancyhelloworld  N bouncing "hello world" images, re-rendered from the
+                       font every frame with a new color, playing a sound
+                       on every bounce.
+    * polygon          One unfilled polygon with N moving vertices.
+    * image            N moving sprites.
+    * drag_n_drop      N squares, with mouse motion and clicks injected into
+                       the event queue so that squares are picked up,
+                       dragged and dropped every frame.
+
+    Run it with
+
+        make stress
+
+    which sets SDL_VIDEODRIVER=dummy and SDL_AUDIODRIVER=dummy. Run from
+    the top of the repository so images/, fonts/ and sounds/ are found.
+
+*****************************************************************************/
+
+#include <cstdlib>
+#include <vector>
+#include "bench.h"
+#include "sdlx.h"
+
+using namespace sdlx;
+
+namespace {
+
+    const int W = 640;
+    const int H = 480;
+
+    // Keeps the time of each frame of a scenario.
+    class Frames
+    {
+    public:
+        Frames(int frames)
+        : _start(0.0)
+        {
+            _ms.reserve(frames);
+        }
+        void begin()
+        {
+            _start = bench::now_ns();
+        }
+        void end()
+        {
+            _ms.push_back((bench::now_ns() - _start) / 1e6);
+        }
+        std::vector<double>& ms()
+        {
+            return _ms;
+        }
+    private:
+        double _start;
+        std::vector<double> _ms;
+    };
+
+    // Drains the event queue the way every demo does.
+    void poll(Event& event)
+    {
+        while (event.poll())
+        {}
+    }
+
+    struct Mover
+    {
+        int x, y, dx, dy;
+    };
+
+    Mover random_mover(int w, int h)
+    {
+        Mover m = { rand() % (W - w), rand() % (H - h),
+                    rand() % 3 + 1, rand() % 3 + 1 };
+        return m;
+    }
+
+    // Moves m by its speed and bounces it off the edges of the window.
+    // Returns true if it bounced.
+    bool bounce(Mover& m, int w, int h)
+    {
+        bool hit = false;
+        m.x += m.dx;
+        if (m.x < 0 || m.x + w > W - 1)
+        {
+            m.dx = -m.dx;
+            m.x += 2 * m.dx;
+            hit = true;
+        }
+        m.y += m.dy;
+        if (m.y < 0 || m.y + h > H - 1)
+        {
+            m.dy = -m.dy;
+            m.y += 2 * m.dy;
+            hit = true;
+        }
+        return hit;
+    }
+
+    //------------------------------------------------------------------------
+    // Scenarios
+    //------------------------------------------------------------------------
+
+    std::vector<double> fancyhelloworld(Window& window, int n, int frames)
+    {
+        Event event;
+        Sound sound("sounds/laser.wav");
+        Font font("fonts/FreeSans.ttf", 48);
+        Image probe("hello world", font, WHITE, window);
+        const int w = probe.get_width();
+        const int h = probe.get_height();
+
+        std::vector<Mover> movers;
+        for (int i = 0; i < n; ++i)
+            movers.push_back(random_mover(w, h));
+
+        Frames timer(frames);
+        for (int f = 0; f < frames; ++f)
+        {
+            timer.begin();
+            poll(event);
+            window.clear(BLACK);
+            for (int i = 0; i < n; ++i)
+            {
+                if (bounce(movers[i], w, h))
+                    sound.play();
+                Color c((f + i) % 256, (2 * f + i) % 256, (3 * f + i) % 256);
+                Image image("hello world", font, c, window);
+                Rect rect = { movers[i].x, movers[i].y, w, h };
+                window.put_image(image, rect);
+            }
+            window.draw();
+            timer.end();
+        }
+        return timer.ms();
+    }
+
+    std::vector<double> polygon(Window& window, int n, int frames)
+    {
+        Event event;
+        std::vector<Point> points(n);
+        std::vector<Mover> movers;
+        for (int i = 0; i < n; ++i)
+            movers.push_back(random_mover(1, 1));
+        Color c(0, 100, 200);
+
+        Frames timer(frames);
+        for (int f = 0; f < frames; ++f)
+        {
+            timer.begin();
+            poll(event);
+            for (int i = 0; i < n; ++i)
+            {
+                bounce(movers[i], 1, 1);
+                points[i].x = movers[i].x;
+                points[i].y = movers[i].y;
+            }
+            window.clear();
+            window.put_unfilled_polygon(points.data(), n, c);
+            window.draw();
+            timer.end();
+        }
+        return timer.ms();
+    }
+
+    std::vector<double> image(Window& window, int n, int frames)
+    {
+        Event event;
+        Image sprite("images/galaxian/GalaxianAquaAlien.gif", window);
+        Rect rect = sprite.get_rect();
+
+        std::vector<Mover> movers;
+        for (int i = 0; i < n; ++i)
+            movers.push_back(random_mover(rect.w, rect.h));
+
+        Frames timer(frames);
+        for (int f = 0; f < frames; ++f)
+        {
+            timer.begin();
+            poll(event);
+            window.clear(BLACK);
+            for (int i = 0; i < n; ++i)
+            {
+                bounce(movers[i], rect.w, rect.h);
+                rect.x = movers[i].x;
+                rect.y = movers[i].y;
+                window.put_image(sprite, rect);
+            }
+            window.draw();
+            timer.end();
+        }
+        return timer.ms();
+    }
+
+    void push_mouse(Uint32 type, int x, int y)
+    {
+        SDL_Event e = SDL_Event();
+        e.type = type;
+        if (type == MOUSEMOTION)
+        {
+            e.motion.x = x;
+            e.motion.y = y;
+        }
+        else
+        {
+            e.button.button = SDL_BUTTON_LEFT;
+            e.button.x = x;
+            e.button.y = y;
+        }
+        SDL_PushEvent(&e);
+    }
+
+    std::vector<double> drag_n_drop(Window& window, int n, int frames)
+    {
+        const int SIZE = 40;
+        Event event;
+        Font font("fonts/FreeSans.ttf", 24);
+        Image help("drag-n-drop sim: click on mouse to pick up/put down",
+                   font, WHITE, window);
+        Rect helprect = help.get_rect();
+
+        std::vector<Mover> squares;
+        std::vector<bool> moving(n, false);
+        for (int i = 0; i < n; ++i)
+            squares.push_back(random_mover(SIZE, SIZE));
+
+        Frames timer(frames);
+        for (int f = 0; f < frames; ++f)
+        {
+            // Click on one square and wiggle the mouse, like a user would.
+            const Mover& target = squares[f % n];
+            push_mouse(MOUSEBUTTONUP, target.x + SIZE / 2, target.y + SIZE / 2);
+            for (int k = 0; k < 4; ++k)
+                push_mouse(MOUSEMOTION, rand() % (W - SIZE), rand() % (H - SIZE));
+
+            timer.begin();
+            while (event.poll())
+            {
+                if (event.type() == MOUSEMOTION)
+                {
+                    Motion motion = event.motion();
+                    for (int i = 0; i < n; ++i)
+                    {
+                        if (moving[i])
+                        {
+                            squares[i].x = motion.x();
+                            squares[i].y = motion.y();
+                        }
+                    }
+                }
+                else if (event.type() == MOUSEBUTTONUP)
+                {
+                    Button button = event.button();
+                    for (int i = 0; i < n; ++i)
+                    {
+                        const Mover& s = squares[i];
+                        if (s.x <= button.x() && button.x() <= s.x + SIZE
+                            && s.y <= button.y() && button.y() <= s.y + SIZE)
+                        {
+                            moving[i] = !moving[i];
+                        }
+                    }
+                }
+            }
+
+            window.clear(BLACK);
+            for (int i = 0; i < n; ++i)
+            {
+                if (moving[i])
+                    window.put_rect(squares[i].x, squares[i].y, SIZE, SIZE, 100, 100, 100);
+                else
+                    window.put_rect(squares[i].x, squares[i].y, SIZE, SIZE, 255, 255, 255);
+            }
+            window.put_image(help, helprect);
+            window.draw();
+            timer.end();
+        }
+        return timer.ms();
+    }
+
+    //------------------------------------------------------------------------
+
+    typedef std::vector<double> (*Scenario)(Window&, int, int);
+
+    void run(std::vector<bench::Result>& results, Window& window,
+             const char* name, Scenario scenario, const int* sizes, int count,
+             int frames)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            srand(245);
+            std::vector<double> ms = scenario(window, sizes[i], frames);
+
+            double total = 0.0;
+            for (size_t j = 0; j < ms.size(); ++j)
+                total += ms[j];
+
+            bench::Result r;
+            r.name = name;
+            r.n = sizes[i];
+            r.metrics.push_back(std::make_pair("frames", double(ms.size())));
+            r.metrics.push_back(std::make_pair("mean_ms", total / ms.size()));
+            r.metrics.push_back(std::make_pair("p50_ms", bench::percentile(ms, 50)));
+            r.metrics.push_back(std::make_pair("p95_ms", bench::percentile(ms, 95)));
+            r.metrics.push_back(std::make_pair("p99_ms", bench::percentile(ms, 99)));
+            r.metrics.push_back(std::make_pair("max_ms", bench::percentile(ms, 100)));
+            results.push_back(r);
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    bench::Options options = bench::parse_options(argc, argv);
+    const int frames = options.quick ? 60 : 600;
+
+    Window window(W, H, OFFSCREEN);
+
+    const int FANCY[]   = { 1, 10, 100 };
+    const int POLYGON[] = { 500, 5000, 50000 };
+    const int IMAGE[]   = { 10, 100, 1000, 10000 };
+    const int DRAG[]    = { 10, 100, 1000 };
+
+    std::vector<bench::Result> results;
+    run(results, window, "fancyhelloworld", fancyhelloworld, FANCY, 3, frames);
+    run(results, window, "polygon", polygon, POLYGON, 3, frames);
+    run(results, window, "image", image, IMAGE, 4, frames);
+    run(results, window, "drag_n_drop", drag_n_drop, DRAG, 3, frames);
+
+    return bench::write_results(options, results);
+}
@@ -0,0 +1,260 @@
+/*
+ * SDLX, a SDL graphics library for CS students.
+ * Copyright (C) 2017, Seth Kasmann, Yihsiang Liow
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef AUDIO_H
+#define AUDIO_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include "effects.h"
+#include "mixer.h"
+#include "pcm.h"
+#include "spatial.h"
+#include "voice.h"
+
+namespace sdlx {
+
+    // Called with every mixed buffer, in the audio thread. It must not
+    // block or allocate.
+    typedef void (*PostMix)(void* data, uint8_t* stream, int bytes);
+
+    struct AudioConfig
+    {
+        AudioConfig();
+        int frequency;      // samples per second
+        uint16_t format;    // AUDIO_S16SYS, AUDIO_F32SYS ...
+        int channels;       // 1 mono, 2 stereo
+        int chunk;          // samples per mixing callback
+        int voices;         // sounds that can play at the same time
+        bool native;        // mix sounds with the NativeMixer (see mixer.h)
+        Resample resample;  // quality of resampling at load time (see pcm.h)
+    };
+
+    // Mixer channels kept out of the VoicePool: one for decoded Music (see
+    // sound.h) and two for a Playlist to crossfade on (see playlist.h).
+    static const int AUDIO_RESERVED = 3;
+
+    struct AudioLatency
+    {
+        double buffer_ms;   // one mixing buffer (chunk / frequency)
+        double output_ms;   // estimated time from mixing to the speaker
+        double period_ms;   // average time between mixing callbacks
+        double jitter_ms;   // average distance from that period
+        uint32_t callbacks; // mixing callbacks so far
+        double loopback_ms; // measured by self_test(), 0 if not run or unheard
+    };
+
+    // Functions that can be added with AudioDevice::add_post_mix().
+    static const int AUDIO_TAPS = 8;
+
+    // Mixing callbacks kept in the history, see AudioDevice::history().
+    static const int AUDIO_HISTORY = 512;
+
+    // The mix_ms fields, overruns and voices stay 0 without
+    // AudioDevice::set_timing().
+    struct AudioStats
+    {
+        uint32_t callbacks;     // mixing callbacks since reset_stats()
+        double mix_ms;          // time spent mixing voices, last callback
+        double mix_ms_avg;      // .. average
+        double mix_ms_max;      // .. worst
+        double period_ms;       // time between the last two callbacks
+        uint32_t overruns;      // callbacks that mixed for longer than a buffer
+        uint32_t underruns;     // callbacks more than half a buffer late
+        int voices;             // voices mixed by the last callback
+        float peak;             // loudest sample of the last callback, 0 .. 1
+        float peak_max;         // loudest sample since reset_stats()
+    };
+
+    // One mixing callback.
+    struct AudioSample
+    {
+        uint64_t time_ns;       // steady clock, when the callback ended
+        float mix_ms;
+        float period_ms;
+        float peak;
+        uint16_t voices;
+        uint8_t underrun;
+        uint8_t overrun;
+    };
+
+    /*************************************************************************
+
+        Class AudioDevice
+
+        There is one audio device, shared by every Sound and Music. It is
+        opened when the first Sound or Music is made and closed when the
+        last one is gone, so making or freeing a Sound never interrupts the
+        others.
+
+        You only need it to choose the format before any sound is loaded:
+
+        AudioConfig config;
+        config.frequency = 48000;
+        config.chunk = 256;             // lower latency
+        context().audio().configure(config);
+
+        Sound laser("sounds/laser.wav");
+
+        If the device is already open the new configuration is used the next
+        time it is opened. spec() is the format the device really got, which
+        can differ from the one asked for.
+
+        The frequency and chunk size can also be set without recompiling
+        with the SDLX_AUDIO_FREQUENCY and SDLX_AUDIO_CHUNK environment
+        variables, which win over configure(). Smaller chunks mean less
+        latency but more callbacks, and crackling if the machine cannot
+        keep up.
+
+        latency() reports the latency the configuration implies and how
+        regularly the mixing callback really runs. self_test() plays clicks
+        and measures how long each one takes to reach the mixed output.
+        It works with any driver, including SDL_AUDIODRIVER=dummy or disk,
+        but should be run while nothing else plays.
+
+        stats() tells where crackling comes from. overruns count callbacks
+        that took longer to mix than the buffer lasts: the mixer is too
+        slow. underruns count callbacks that came more than half a buffer
+        later than expected: the audio thread was not run in time and the
+        device most likely ran out of samples. history() copies the last
+        AUDIO_HISTORY callbacks since the device was opened or
+        reset_stats() was called, oldest first, without stopping the audio
+        thread:
+
+        std::vector<AudioSample> h;
+        context().audio().history(h);
+
+        mix_ms, overruns and voices are only measured after
+        set_timing(true). mix_ms then runs from the first voice mixed to the
+        end of the callback, so music alone is not timed. To find that first
+        voice an effect is added to every voice, and SDL_mixer copies the
+        buffer of each voice that has an effect into a newly allocated one
+        on every callback. That is a heap allocation per voice per callback
+        in the audio thread, and it makes mix_ms itself larger, so timing is
+        off unless you are profiling. It applies to voices started after
+        the call.
+
+        SDL_mixer has a single post-mix hook. The device owns it and passes
+        each mixed buffer to every function added with add_post_mix(), up to
+        AUDIO_TAPS of them. Adding and removing briefly locks the audio
+        thread out, so once remove_post_mix() returns the function is no
+        longer running and its data can be freed. The callback itself never
+        takes a lock.
+
+        voices() decides which voice plays each Sound (see voice.h).
+        Sounds are converted to the device format when they are loaded and
+        kept in pcm() (see pcm.h), so the mixing callback never converts.
+        The first AUDIO_RESERVED channels are left out of voices() for
+        music that was decoded up front and for the Playlist.
+
+        spatial() plays sounds at a position relative to a listener (see
+        spatial.h). effects() filters, compresses and adds reverb to
+        everything that is played (see effects.h).
+
+        With AudioConfig::native set, the device is opened in float stereo
+        and sounds are played by native() instead (see mixer.h), which adds
+        them to what SDL_mixer mixed in the same callback. play() and stop()
+        go to whichever of the two is in use.
+
+        acquire() and release() open and close the device on behalf of an
+        object that plays sound. Each acquire() that returns true must be
+        matched by one release().
+
+    *************************************************************************/
+
+    class AudioDevice
+    {
+    public:
+        AudioDevice();
+        ~AudioDevice();
+        AudioDevice(const AudioDevice& other) = delete;
+        AudioDevice& operator=(const AudioDevice& other) = delete;
+        void configure(const AudioConfig& config);
+        const AudioConfig& config() const;
+        AudioConfig spec() const;
+        bool is_open() const;
+        int users() const;
+        bool acquire();
+        void release();
+        void close();
+        VoicePool& voices();
+        NativeMixer& native();
+        PcmCache& pcm();
+        Spatial& spatial();
+        EffectChain& effects();
+        int play(Mix_Chunk* chunk, const VoiceParams& params);
+        void stop(Mix_Chunk* chunk);
+        void add_post_mix(PostMix f, void* data);
+        void remove_post_mix(PostMix f, void* data);
+        AudioLatency latency() const;
+        AudioLatency self_test(int clicks=8);
+        AudioStats stats() const;
+        void reset_stats();
+        void set_timing(bool timing);
+        size_t history(std::vector<AudioSample>& samples) const;
+    private:
+        mutable std::mutex _mutex;
+        AudioConfig _config;
+        AudioConfig _spec;
+        VoicePool _voices;
+        NativeMixer _native;
+        PcmCache _pcm;
+        Spatial _spatial;
+        EffectChain _effects;
+        int _users;
+        bool _open;
+        bool _timing;
+
+        std::mutex _taps_mutex;
+        std::pair<PostMix, void*> _taps[AUDIO_TAPS];
+        int _tap_count;
+        std::atomic<uint32_t> _callbacks;
+        std::atomic<uint64_t> _last_ns;
+        std::atomic<uint64_t> _period_ns;
+        std::atomic<uint64_t> _jitter_ns;
+        double _loopback_ms;
+
+        // Written only by the audio thread.
+        std::atomic<uint64_t> _mix_start_ns;
+        std::atomic<int> _mixed;
+        std::atomic<uint32_t> _stat_callbacks;
+        std::atomic<uint64_t> _mix_ns;
+        std::atomic<uint64_t> _mix_total_ns;
+        std::atomic<uint64_t> _mix_max_ns;
+        std::atomic<uint64_t> _last_period_ns;
+        std::atomic<uint32_t> _overruns;
+        std::atomic<uint32_t> _underruns;
+        std::atomic<int> _voices_mixed;
+        std::atomic<float> _peak;
+        std::atomic<float> _peak_max;
+        std::atomic<bool> _reset;
+        AudioSample _history[AUDIO_HISTORY];
+        std::atomic<uint64_t> _head;
+        std::atomic<uint64_t> _first;       // oldest sample since the reset
+
+        float _measure_peak(const uint8_t* stream, int bytes) const;
+        void _record(uint64_t now, uint64_t period);
+        static void _post_mix(void* device, uint8_t* stream, int bytes);
+        static void _voice_mixed(int channel, void* stream, int bytes, void* device);
+    };
+}
+
+#endif
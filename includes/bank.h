@@ -0,0 +1,117 @@
+/*
+ * SDLX, a SDL graphics library for CS students.
+ * Copyright (C) 2017, Seth Kasmann, Yihsiang Liow
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BANK_H
+#define BANK_H
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include "pool.h"
+#include "voice.h"
+
+class Mix_Chunk;
+
+namespace sdlx {
+
+    class SoundBank;
+
+    /*************************************************************************
+
+        A SoundHandle plays a sample of a SoundBank. It is only a pointer
+        and the voice settings, so it is cheap to copy and keep around.
+        Each handle has its own settings (see voice.h), e.g. two handles to
+        the same sample can have different priorities.
+
+        play() and play_at() (see spatial.h) do nothing and return -1 until
+        the sample is loaded.
+
+    *************************************************************************/
+
+    class SoundHandle
+    {
+    public:
+        SoundHandle();
+        bool ready() const;
+        int play();
+        int play_at(float x, float y);
+        void set_priority(int priority);
+        void set_limit(int limit);
+        void set_coalesce(uint32_t ms);
+        void set_volume(int volume);
+    private:
+        struct Sample;
+        const Sample* _sample;
+        VoiceParams _params;
+
+        friend class SoundBank;
+    };
+
+    /*************************************************************************
+
+        Class SoundBank
+
+        A SoundBank loads many samples at once, decoding them in parallel on
+        background threads, and keeps exactly one copy of each file however
+        many times it is asked for.
+
+        USAGE:
+        SoundBank bank;
+        bank.load("sounds");                // every file in the directory
+        bank.load_manifest("level1.txt");   // one file per line, # comments
+        bank.wait();                        // or keep going and check ready()
+
+        SoundHandle laser = bank.get("sounds/laser.wav");
+        laser.play();
+
+        Samples are named by the path they were loaded from. Loading the
+        same file again, under any spelling, does nothing.
+
+        Handles must not be used after their bank is gone.
+
+    *************************************************************************/
+
+    class SoundBank
+    {
+    public:
+        SoundBank(int threads=0);
+        ~SoundBank();
+        SoundBank(const SoundBank& other) = delete;
+        SoundBank& operator=(const SoundBank& other) = delete;
+        int load(const std::string& path);
+        int load_manifest(const std::string& filename);
+        void wait();
+        int pending() const;
+        SoundHandle get(const std::string& name) const;
+        size_t size() const;
+        size_t bytes() const;
+    private:
+        typedef SoundHandle::Sample Sample;
+
+        std::unordered_map<std::string, std::unique_ptr<Sample> > _samples;
+        std::unordered_map<std::string, Sample*> _names;
+        std::atomic<int> _pending;
+        bool _audio;
+        ThreadPool _pool;
+
+        bool _add(const std::string& filename);
+    };
+}
+
+#endif
@@ -0,0 +1,77 @@
+/*
+ * SDLX, a SDL graphics library for CS students.
+ * Copyright (C) 2017, Seth Kasmann, Yihsiang Liow
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <map>
+#include <memory>
+#include <string>
+#include "image.h"
+
+namespace sdlx {
+
+    class Window;
+
+    /*************************************************************************
+
+        An ImageCache loads each image file only once.
+
+        get() returns a shared pointer to the Image for a file. Asking for
+        the same file again (even as "./images/a.gif" instead of
+        "images/a.gif") returns the same Image, without reading the file or
+        making another texture. When the last pointer to an Image goes away
+        its texture is freed; asking for the file after that loads it again.
+
+        If the file cannot be loaded get() returns an empty pointer.
+
+        Use the cache from the thread that draws.
+
+        USAGE:
+
+        ImageCache cache(window);
+        std::shared_ptr<Image> icon = cache.get("images/galaxian/GalaxianFlagship.gif");
+        std::shared_ptr<Image> same = cache.get("images/galaxian/GalaxianFlagship.gif");
+
+        window.put_image(*icon, rect);
+
+        std::cout << cache.resident_bytes() << " bytes in "
+                  << cache.size() << " images\n";
+
+    *************************************************************************/
+
+    class ImageCache
+    {
+    public:
+        ImageCache(Window& window);
+        std::shared_ptr<Image> get(const std::string& filename);
+        int refcount(const std::string& filename) const;
+        size_t size() const;
+        size_t resident_bytes() const;
+        void purge();
+    private:
+        Window& _window;
+        std::map<std::string, std::weak_ptr<Image> > _images;
+
+        // A cache should not be copied.
+        ImageCache(const ImageCache& c);
+        void operator=(const ImageCache& c);
+    };
+}
+
+#endif
@@ -0,0 +1,106 @@
+/*
+ * SDLX, a SDL graphics library for CS students.
+ * Copyright (C) 2017, Seth Kasmann, Yihsiang Liow
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "types.h"
+
+class SDL_Renderer;
+
+namespace sdlx {
+
+    // Number of frames that can wait to be written at the same time.
+    static const int CAPTURE_BUFFERS = 4;
+
+    /*************************************************************************
+
+        A Capture saves frames of a Window to files without making the game
+        loop wait for the disk.
+
+        You do not create a Capture yourself. Ask the Window for one:
+
+        window.capture_async("frame.png");
+
+        The next window.draw() copies the frame into one of CAPTURE_BUFFERS
+        preallocated buffers and a background thread writes it out. The file
+        type is chosen by the extension:
+            - .png  PNG
+            - .bmp  BMP
+            - anything else: raw 32-bit ARGB pixels, row after row
+
+        With no file name, frames are named capture_00000.png,
+        capture_00001.png ...
+
+        If all of the buffers are still waiting to be written the frame is
+        skipped and counted in captures_dropped(). The performance overlay
+        (see hud.h) is not part of the captured frame.
+
+    *************************************************************************/
+
+    class Capture
+    {
+    public:
+        Capture();
+        ~Capture();
+        void request(const std::string& filename);
+        void service(SDL_Renderer* renderer);
+        void flush();
+        uint32_t dropped() const;
+        uint32_t written() const;
+    private:
+        struct Slot
+        {
+            Slot()
+                : busy(false), w(0), h(0)
+            {}
+            bool busy;
+            int w, h;
+            std::string filename;
+            std::vector<uint8_t> pixels;
+        };
+
+        Slot _slots[CAPTURE_BUFFERS];
+        std::deque<int> _queue;
+        std::vector<std::string> _requests;
+        std::mutex _mutex;
+        std::condition_variable _ready;
+        std::condition_variable _done;
+        std::thread _worker;
+        bool _quit;
+        uint32_t _next;
+        uint32_t _dropped;
+        std::atomic<uint32_t> _written;
+
+        void _run();
+        void _write(Slot& slot);
+
+        // A capture should not be copied.
+        Capture(const Capture& c);
+        void operator=(const Capture& c);
+    };
+}
+
+#endif
@@ -0,0 +1,116 @@
+/*
+ * SDLX, a SDL graphics library for CS students.
+ * Copyright (C) 2017, Seth Kasmann, Yihsiang Liow
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CONTEXT_H
+#define CONTEXT_H
+
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include "audio.h"
+
+namespace sdlx {
+
+    // Subsystems that can be initialized. Combine them with |.
+    enum Subsystem
+    {
+        INIT_TIMER          = 1 << 0,
+        INIT_AUDIO          = 1 << 1,
+        INIT_VIDEO          = 1 << 2,
+        INIT_JOYSTICK       = 1 << 3,
+        INIT_HAPTIC         = 1 << 4,
+        INIT_GAMECONTROLLER = 1 << 5,
+        INIT_EVENTS         = 1 << 6,
+        INIT_IMAGE          = 1 << 7,   // SDL_image
+        INIT_TTF            = 1 << 8,   // SDL_ttf
+        INIT_MIXER          = 1 << 9    // SDL_mixer, needs INIT_AUDIO
+    };
+
+    static const int SUBSYSTEMS = 10;
+
+    /*************************************************************************
+
+        Class Context
+
+        The Context initializes SDL and its libraries, one subsystem at a
+        time and only when something needs it:
+
+            Window               video (events only when offscreen)
+            Event                events
+            Image from a file    SDL_image
+            Font                 SDL_ttf
+            Sound, Music         audio and SDL_mixer
+            Joystick             joystick
+
+        A program that only draws into an offscreen Window never starts the
+        audio or joystick subsystems. Everything that was started is shut
+        down when the program ends.
+
+        There is one Context per program. To start subsystems up front, e.g.
+        to keep the first frame from paying for them, require them:
+
+        context().require(INIT_VIDEO | INIT_AUDIO | INIT_MIXER);
+
+        The context also owns the audio device that every Sound and Music
+        shares (see audio.h):
+
+        context().audio().configure(config);
+
+        The time each subsystem took to start can be printed:
+
+        context().print_startup();
+
+        require() returns false, after printing the error, if a subsystem
+        could not be started. INIT_IMAGE and INIT_MIXER also fail when some
+        of their formats (JPG, PNG, TIF or FLAC, OGG) are missing; the other
+        formats still work. A subsystem that failed is not tried again and
+        later calls return false without printing. require() can be called
+        from any thread.
+
+    *************************************************************************/
+
+    class Context
+    {
+    public:
+        bool require(uint32_t subsystems);
+        bool ready(uint32_t subsystems) const;
+        double startup_ms(Subsystem subsystem) const;
+        void print_startup(std::ostream& out=std::cout) const;
+        AudioDevice& audio();
+        Context(const Context& other) = delete;
+        Context& operator=(const Context& other) = delete;
+    private:
+        Context();
+        ~Context();
+        bool _start(int i);
+        void _stop(int i);
+
+        std::atomic<uint32_t> _ready;
+        uint32_t _failed;
+        std::mutex _mutex;
+        double _ms[SUBSYSTEMS];
+        AudioDevice _audio;
+
+        friend Context& context();
+    };
+
+    Context& context();
+}
+
+#endif
@@ -94,6 +94,8 @@ namespace sdlx {
 
         (See a list of available hats in constants.h)
 
+        A Joystick can be moved but not copied.
+
         The function get_axis(int axis) will return the value of the axis
         from -32768 to 32767. Normally passing in 0 gives you the x-axis,
         and 1 gives you the y axis. While this may not always be the case
@@ -105,6 +107,10 @@ namespace sdlx {
     {
     public:
         Joystick();
+        Joystick(Joystick&& other);
+        Joystick& operator=(Joystick&& other);
+        Joystick(const Joystick& other) = delete;
+        Joystick& operator=(const Joystick& other) = delete;
         ~Joystick();
         int num_balls() const;
         int num_buttons() const;
@@ -0,0 +1,163 @@
+/*
+ * SDLX, a SDL graphics library for CS students.
+ * Copyright (C) 2017, Seth Kasmann, Yihsiang Liow
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EFFECTS_H
+#define EFFECTS_H
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace sdlx {
+
+    class AudioDevice;
+    struct AudioConfig;
+
+    enum FilterType
+    {
+        FILTER_OFF,
+        FILTER_LOWPASS,
+        FILTER_HIGHPASS
+    };
+
+    struct EffectSettings
+    {
+        EffectSettings();
+        FilterType filter;
+        float cutoff;           // Hz
+        float q;                // 0.707 for no resonance
+
+        bool compressor;
+        float threshold_db;     // compress above this level
+        float ratio;            // 4 means 4 dB in, 1 dB out above threshold
+        float attack_ms;
+        float release_ms;
+        float makeup_db;        // gain after compressing
+
+        bool limiter;
+        float ceiling_db;       // nothing louder comes out
+
+        float reverb;           // 0 (off) .. 1, how much reverb is added
+        float room;             // 0 .. 1, how long it rings
+        float damping;          // 0 .. 1, how dull the reflections are
+    };
+
+    // Longest buffer processed in one go. Longer ones are split.
+    static const int EFFECT_BLOCK = 1024;
+
+    /*************************************************************************
+
+        Class EffectChain
+
+        Effects applied to everything the audio device plays, after it is
+        mixed: a low-pass or high-pass filter, a compressor, a reverb and
+        a limiter, in that order. Filtering the whole mix at run time
+        replaces keeping filtered copies of every sample (e.g. for an
+        underwater or a pause screen sound).
+
+        The audio device owns one, which is off until it is set:
+
+        EffectSettings fx;
+        fx.filter = FILTER_LOWPASS;
+        fx.cutoff = 800;
+        fx.reverb = 0.3f;
+        context().audio().effects().set(fx);
+
+        ...
+
+        context().audio().effects().set(EffectSettings());     // all off
+
+        set() can be called at any time from any thread. The new settings
+        are picked up by the next mixing callback, which never waits for
+        set(), allocates or takes a lock. Everything the effects need is
+        allocated when the device opens.
+
+        It works on 16-bit and float samples, mono or stereo. Music, the
+        Playlist, SDL_mixer's channels and the NativeMixer (see mixer.h) all
+        end up in the one buffer it processes. The filter and reverb use
+        SSE2 where the CPU has it. reduction_db() is how much the
+        compressor and limiter turned the last buffer down.
+
+    *************************************************************************/
+
+    class EffectChain
+    {
+    public:
+        EffectChain();
+        ~EffectChain();
+        EffectChain(const EffectChain& other) = delete;
+        EffectChain& operator=(const EffectChain& other) = delete;
+        void set(const EffectSettings& settings);
+        EffectSettings settings() const;
+        float reduction_db() const;
+        void attach(AudioDevice& device, const AudioConfig& spec);
+        void detach();
+    private:
+        struct Params
+        {
+            EffectSettings s;
+            float b0, b1, b2, a1, a2;                   // filter
+            float threshold, slope, attack, release;    // compressor
+            float makeup;
+            float ceiling, limit_attack, limit_release; // limiter
+            float feedback, damp;                       // reverb
+        };
+
+        static const int COMBS = 4;
+        static const int ALLPASSES = 2;
+
+        struct Delay
+        {
+            std::vector<float> buffer;
+            int position;
+        };
+
+        // Written by set(), read by the audio thread when it can.
+        Params _pending;
+        std::atomic<bool> _changed;
+        mutable std::atomic<bool> _busy;
+
+        // Audio thread only.
+        Params _params;
+        AudioDevice* _device;
+        uint16_t _format;
+        int _channels;
+        int _frequency;
+        float _z1[2], _z2[2];
+        float _compress_env;
+        float _limit_env;
+        Delay _combs[2][COMBS];
+        float _comb_store[2][COMBS];
+        Delay _allpasses[2][ALLPASSES];
+        std::vector<float> _float;      // 16-bit samples converted
+        std::vector<float> _gain;
+        std::vector<float> _wet;
+        std::atomic<float> _reduction;
+
+        Params _compute(const EffectSettings& s) const;
+        void _reset();
+        void _process(float* samples, int frames);
+        void _filter(float* samples, int frames);
+        float _dynamics(float* samples, int frames, float& env, float threshold,
+                        float slope, float attack, float release, float makeup);
+        void _reverb(float* samples, int frames);
+        static void _run(void* chain, uint8_t* stream, int bytes);
+    };
+}
+
+#endif
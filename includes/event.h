@@ -82,6 +82,7 @@ namespace sdlx {
     class Event
     {
     public:
+        Event();
         int poll();
         int type() const;
 
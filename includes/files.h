@@ -0,0 +1,41 @@
+/*
+ * SDLX, a SDL graphics library for CS students.
+ * Copyright (C) 2017, Seth Kasmann, Yihsiang Liow
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FILES_H
+#define FILES_H
+
+#include <string>
+#include <vector>
+
+namespace sdlx {
+
+    // The absolute path of a file with "." / ".." and links resolved, so
+    // every spelling of the same file gives the same string. If the file
+    // does not exist the path is returned as it is.
+    std::string canonical_path(const std::string& path);
+
+    // Every file under dir and its subdirectories, sorted, with '/'
+    // separators, e.g. "sounds/laser.wav". Prints an error and returns
+    // nothing if dir cannot be read.
+    std::vector<std::string> list_files(const std::string& dir);
+
+    // True if path is a directory.
+    bool is_directory(const std::string& path);
+}
+
+#endif
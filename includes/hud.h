@@ -0,0 +1,70 @@
+/*
+ * SDLX, a SDL graphics library for CS students.
+ * Copyright (C) 2017, Seth Kasmann, Yihsiang Liow
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HUD_H
+#define HUD_H
+
+#include <vector>
+#include "types.h"
+#include "window.h"
+
+class SDL_Renderer;
+
+namespace sdlx {
+
+    // Number of frames shown in the frame-time graph.
+    static const int HUD_FRAMES = 120;
+
+    /*************************************************************************
+
+        A Hud draws a small performance overlay in the top-left corner of a
+        Window: a graph of the last HUD_FRAMES frame times, the fps, the
+        50th/95th/99th percentile frame time and the draw calls, primitives
+        and texture memory of the last frame.
+
+        You do not create a Hud yourself. Turn it on and off with the Window:
+
+        window.show_hud();      // turn it on
+        window.toggle_hud();    // flip it, e.g. when F1 is pressed
+        window.show_hud(false); // turn it off
+
+        The overlay is drawn with a built-in 3x5 pixel font and a handful of
+        batched draw calls, and is not counted in the Window's RenderStats.
+
+    *************************************************************************/
+
+    class Hud
+    {
+    public:
+        Hud();
+        void push(double ms);
+        void render(SDL_Renderer* renderer, const RenderStats& stats);
+    private:
+        float _ms[HUD_FRAMES];
+        float _sorted[HUD_FRAMES];
+        int _head;
+        int _count;
+        std::vector<Rect> _glyphs;
+        std::vector<Point> _graph;
+
+        void _text(int x, int y, const char* s);
+        void _fill(SDL_Renderer* renderer, const Color& c);
+    };
+}
+
+#endif
@@ -24,16 +24,46 @@
 #include "types.h"
 
 class SDL_Texture;
+class SDL_Surface;
 class _TTF_Font;
 
 namespace sdlx {
     
     class Window;
-    
+
+    /*************************************************************************
+
+        Fonts and Images own what they load. They can be moved, e.g. into a
+        std::vector or out of a function, but not copied: a copy would free
+        the same font or texture twice. A moved-from object is empty.
+
+        std::vector<Image> sprites;
+        sprites.push_back(Image("images/galaxian/GalaxianFlagship.gif", window));
+
+        Both can also be made from memory instead of a file, e.g. from a file
+        embedded in the program (see tools/embed.cpp) or an asset pack (see
+        pack.h):
+            - Font(span, size) reads a TTF file held in memory. The memory
+              must stay valid for as long as the Font is used.
+            - Image(span, window) decodes an image file held in memory.
+            - Image(w, h, format, pixels, pitch, window) uploads pixels in an
+              SDL_PIXELFORMAT_* format straight into a texture without any
+              decoding.
+
+        #include "embedded.h"
+        Font font(assets::fonts_FreeSans_ttf, 24);
+
+    *************************************************************************/
+
     class Font
     {
     public:
         Font(const std::string& fontfamily="fonts/FreeSans.fft", size_t size=12);
+        Font(Span file, size_t size);
+        Font(Font&& other);
+        Font& operator=(Font&& other);
+        Font(const Font& other) = delete;
+        Font& operator=(const Font& other) = delete;
         ~Font();
         _TTF_Font* get_font();
     private:
@@ -45,16 +75,31 @@ namespace sdlx {
     public:
         Image();
         Image(const std::string& filename, Window& window);
+        Image(Span file, Window& window);
         Image(const std::string& text, Font& font, const Color& c, Window& window);
+        Image(SDL_Surface* surface, Window& window);
+        Image(int w, int h, uint32_t format, const void* pixels, int pitch,
+              Window& window);
+        Image(Image&& other);
+        Image& operator=(Image&& other);
+        Image(const Image& other) = delete;
+        Image& operator=(const Image& other) = delete;
         ~Image();
         SDL_Texture* get_texture();
         int get_width() const;
         int get_height() const;
+        size_t get_bytes() const;
         Rect get_rect() const;
     private:
           SDL_Texture* _image;
           int _w, _h;
+
+          void _query();
+          void _free();
     };
+
+    // Bytes of texture memory held by all Images that are currently alive.
+    size_t texture_memory();
 }
 #endif
 
@@ -0,0 +1,127 @@
+/*
+ * SDLX, a SDL graphics library for CS students.
+ * Copyright (C) 2017, Seth Kasmann, Yihsiang Liow
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LOADER_H
+#define LOADER_H
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include "image.h"
+#include "pool.h"
+
+class SDL_Surface;
+
+namespace sdlx {
+
+    class Window;
+
+    /*************************************************************************
+
+        An AssetLoader loads images in the background so the game loop does
+        not freeze while a level's worth of sprites is read from disk.
+
+        load() returns right away with an ImageHandle. The file is decoded
+        on a pool of background threads. Textures can only be made on the
+        thread that draws, so call update() once per frame: it turns decoded
+        images into textures until it has used up its time budget (in
+        milliseconds) and leaves the rest for the next frame.
+
+        A file that cannot be loaded does not stop the program. Its handle
+        reports failed() and error() tells you why. Only call get() once
+        the handle is ready(); before that it prints an error and returns an
+        empty image.
+
+        USAGE:
+
+        AssetLoader loader(window);
+        ImageHandle alien = loader.load("images/galaxian/GalaxianAquaAlien.gif");
+
+        while (!quit)
+        {
+            loader.update(2);               // at most ~2 ms per frame
+
+            if (alien.ready())
+                window.put_image(alien.get(), rect);
+            else if (alien.failed())
+                std::cout << alien.error() << '\n';
+
+            window.draw();
+        }
+
+        To show a loading screen instead, call loader.finish(), which waits
+        until every image is ready or has failed.
+
+    *************************************************************************/
+
+    class ImageHandle
+    {
+    public:
+        ImageHandle();
+        bool ready() const;
+        bool failed() const;
+        bool done() const;
+        const std::string& filename() const;
+        const std::string& error() const;
+        Image& get();
+    private:
+        friend class AssetLoader;
+
+        enum { LOADING, DECODED, READY, FAILED };
+
+        struct State
+        {
+            std::string filename;
+            std::string error;
+            SDL_Surface* surface;
+            std::unique_ptr<Image> image;
+            std::atomic<int> status;
+        };
+
+        std::shared_ptr<State> _state;
+    };
+
+    class AssetLoader
+    {
+    public:
+        AssetLoader(Window& window, int threads=0);
+        ~AssetLoader();
+        ImageHandle load(const std::string& filename);
+        int update(double budget_ms=2.0);
+        void finish();
+        int pending() const;
+    private:
+        typedef std::shared_ptr<ImageHandle::State> StatePtr;
+
+        Window& _window;
+        std::mutex _mutex;
+        std::deque<StatePtr> _decoded;
+        std::atomic<int> _pending;
+        ThreadPool _pool;
+
+        void _decode(StatePtr state);
+
+        // A loader should not be copied.
+        AssetLoader(const AssetLoader& l);
+        void operator=(const AssetLoader& l);
+    };
+}
+
+#endif
@@ -0,0 +1,66 @@
+/*
+ * SDLX, a SDL graphics library for CS students.
+ * Copyright (C) 2017, Seth Kasmann, Yihsiang Liow
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MAPPED_H
+#define MAPPED_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace sdlx {
+
+    /*************************************************************************
+
+        A MappedFile maps a whole file into memory, read-only. Nothing is
+        read until the bytes are touched, and pages the OS has already
+        cached are shared instead of copied.
+
+        USAGE:
+        MappedFile file("assets.pak");
+        if (file.is_open())
+            use(file.data(), file.size());
+
+        The pointer returned by data() is valid until the MappedFile is
+        closed or destroyed. A MappedFile can be moved but not copied.
+
+    *************************************************************************/
+
+    class MappedFile
+    {
+    public:
+        MappedFile();
+        MappedFile(const std::string& filename);
+        MappedFile(MappedFile&& other);
+        MappedFile& operator=(MappedFile&& other);
+        MappedFile(const MappedFile& other) = delete;
+        MappedFile& operator=(const MappedFile& other) = delete;
+        ~MappedFile();
+        bool open(const std::string& filename);
+        void close();
+        bool is_open() const;
+        const uint8_t* data() const;
+        size_t size() const;
+    private:
+        const uint8_t* _data;
+        size_t _size;
+        void* _handle;      // file mapping object on Windows, unused elsewhere
+    };
+}
+
+#endif
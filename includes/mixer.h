@@ -0,0 +1,168 @@
+/*
+ * SDLX, a SDL graphics library for CS students.
+ * Copyright (C) 2017, Seth Kasmann, Yihsiang Liow
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIXER_H
+#define MIXER_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include "voice.h"
+
+class Mix_Chunk;
+
+namespace sdlx {
+
+    // Voices the native mixer can play at the same time.
+    static const int MIXER_VOICES = 256;
+
+    // Commands that can wait for the audio thread. More are dropped.
+    static const int MIXER_COMMANDS = 1024;
+
+    struct MixerStats
+    {
+        uint32_t callbacks;
+        double mix_ms;          // last callback
+        double mix_ms_avg;
+        double mix_ms_max;
+        int voices;             // voices mixed by the last callback
+        uint32_t dropped;       // commands lost because the queue was full
+        const char* simd;       // "avx2", "sse2" or "scalar"
+    };
+
+    /*************************************************************************
+
+        Class NativeMixer
+
+        An alternative to SDL_mixer's channels for programs that play many
+        sounds at once. It mixes up to MIXER_VOICES voices in float with
+        AVX2 or SSE2, whichever the CPU has. It does not open a device of
+        its own: SDL_mixer's device is opened in float stereo and the
+        voices are added to each buffer SDL_mixer has mixed, from the
+        AudioDevice's post-mix hook.
+
+        Turn it on before any sound is loaded:
+
+        AudioConfig config;
+        config.native = true;
+        context().audio().configure(config);
+
+        Sound laser("sounds/laser.wav");
+        laser.play();                   // now played by the native mixer
+
+        Nothing else changes: Sound::play() and SoundBank handles use it,
+        with the same priorities, limits and coalescing as the VoicePool
+        (see voice.h). Music and Playlist are still played by SDL_mixer and
+        end up in the same buffer.
+
+        The game thread talks to the audio thread through a fixed-size,
+        lock-free queue. mix() never takes a lock, allocates or waits.
+        play(), stop(), set_volume() and set_pan() can be called from any
+        thread; they are serialized before the queue.
+
+        set_pan() moves a playing voice from -1 (left) to 1 (right).
+
+    *************************************************************************/
+
+    class NativeMixer
+    {
+    public:
+        NativeMixer();
+        ~NativeMixer();
+        NativeMixer(const NativeMixer& other) = delete;
+        NativeMixer& operator=(const NativeMixer& other) = delete;
+        void open(int frequency);
+        void close();
+        bool is_open() const;
+        void set_steal(Steal steal);
+        int play(Mix_Chunk* chunk, const VoiceParams& params, float pan=0.0f);
+        void stop(Mix_Chunk* chunk);
+        void stop_voice(int voice);
+        void set_volume(int voice, int volume);
+        void set_pan(int voice, float pan);
+        bool playing(int voice) const;
+        int active() const;
+        void mix(uint8_t* stream, int bytes);
+        MixerStats stats() const;
+    private:
+        enum Type { PLAY, STOP, STOP_SAMPLE, VOLUME, PAN };
+
+        struct Command
+        {
+            Type type;
+            int voice;
+            const float* samples;
+            uint32_t frames;
+            float volume;
+            float pan;
+        };
+
+        // Owned by the audio thread.
+        struct Voice
+        {
+            const float* samples;   // interleaved stereo
+            uint32_t frames;
+            uint32_t position;
+            float volume;
+            float pan;
+            int id;
+        };
+
+        // The game thread's idea of each voice, to choose voices without
+        // asking the audio thread.
+        struct Slot
+        {
+            Mix_Chunk* chunk;
+            int priority;
+            int volume;
+            int id;
+            uint32_t start;
+            uint32_t end;
+        };
+
+        mutable std::mutex _mutex;          // game threads only
+        Slot _slots[MIXER_VOICES];
+        std::unordered_map<Mix_Chunk*, uint32_t> _last;
+        Steal _steal;
+        int _generation;
+        int _frequency;
+        bool _open;                         // changed under Mix_LockAudio()
+
+        Command _queue[MIXER_COMMANDS];
+        std::atomic<uint32_t> _head;        // written by game threads
+        std::atomic<uint32_t> _tail;        // written by the audio thread
+        std::atomic<uint32_t> _dropped;
+
+        Voice _voices[MIXER_VOICES];        // audio thread only
+        std::atomic<uint32_t> _callbacks;
+        std::atomic<uint64_t> _mix_ns;
+        std::atomic<uint64_t> _mix_total_ns;
+        std::atomic<uint64_t> _mix_max_ns;
+        std::atomic<int> _active;
+
+        bool _push(const Command& c);
+        void _drain();
+        bool _busy(int i, uint32_t now) const;
+        int _choose(Mix_Chunk* chunk, const VoiceParams& params, uint32_t now);
+        void _apply(const Command& c);
+        void _render(float* out, int frames);
+    };
+}
+
+#endif
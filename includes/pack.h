@@ -0,0 +1,175 @@
+/*
+ * SDLX, a SDL graphics library for CS students.
+ * Copyright (C) 2017, Seth Kasmann, Yihsiang Liow
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PACK_H
+#define PACK_H
+
+#include <string>
+#include <unordered_map>
+#include "image.h"
+#include "mapped.h"
+#include "sound.h"
+
+class SDL_RWops;
+
+namespace sdlx {
+
+    class Window;
+
+    // Longest asset name in a pack, including the terminating '\0'.
+    static const int PACK_NAME = 64;
+
+    // Every payload in a pack starts at a multiple of PACK_ALIGN bytes.
+    static const int PACK_ALIGN = 64;
+
+    static const uint32_t PACK_VERSION = 2;
+
+    // PackEntry::atlas of an entry that is not in an atlas.
+    static const uint32_t PACK_NONE = 0xffffffff;
+
+    enum PackType
+    {
+        PACK_IMAGE = 1,     // pixels, ready to upload to a texture
+        PACK_FONT  = 2,     // a TTF file, as is
+        PACK_SOUND = 3,     // PCM samples, ready to play
+        PACK_REGION = 4,    // an image inside an atlas page
+        PACK_FILE  = 5      // any other file, as is
+    };
+
+    /*************************************************************************
+
+        A pack file is laid out as
+
+            PackHeader
+            PackEntry[count]                the index
+            payloads, each PACK_ALIGN aligned
+
+        All numbers are little endian. The meaning of the numbers in an
+        entry depends on its type:
+
+                    format                  width       height     pitch
+            IMAGE   SDL_PIXELFORMAT_*       width       height     bytes/row
+            REGION  SDL_PIXELFORMAT_*       width       height     bytes/row
+            FONT    0                       0           0          0
+            SOUND   AUDIO_* sample format   frequency   channels   0
+            FILE    0                       0           0          0
+
+        A REGION is an image that was packed into an atlas page. The page is
+        an IMAGE entry, atlas is its position in the index and x, y is where
+        the region starts in it. The region's offset points at its first
+        pixel inside the page and its pitch is the page's, so a region can
+        be read like any other image.
+
+        hash is the FNV-1a hash of the source file the entry was made from.
+
+    *************************************************************************/
+
+    struct PackHeader
+    {
+        char magic[8];          // "SDLXPAK\0"
+        uint32_t version;
+        uint32_t count;
+    };
+
+    struct PackEntry
+    {
+        char name[PACK_NAME];
+        uint32_t type;
+        uint32_t format;
+        uint32_t width;
+        uint32_t height;
+        uint32_t pitch;
+        uint32_t hash;
+        uint32_t atlas;
+        uint32_t x;
+        uint32_t y;
+        uint32_t reserved;
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    /*************************************************************************
+
+        Class Pack
+
+        A Pack opens a pack file made by the pack tool (see tools/). The file
+        is memory mapped, not read: images, fonts and sounds are made
+        straight from the mapped bytes with no decoding.
+
+        USAGE:
+        Pack pack("assets.pak");    // made with "make pack"
+
+        Image ship = pack.image("images/galaxian/GalaxianFlagship.gif", window);
+        Font font = pack.font("fonts/FreeSans.ttf", 24);
+        Sound laser = pack.sound("sounds/laser.wav");
+
+        Assets are looked up by the path they were packed from. Fonts and
+        Sounds keep reading from the pack, so the Pack must live longer than
+        them. Images are copied into textures and do not need the Pack
+        afterwards.
+
+        Music (OGG, MP3 ...) is packed as it is and streamed straight from
+        the mapping while it plays, so it is never copied and the file is
+        opened only once:
+
+        Music music = pack.music("sounds/GameLoop.ogg");
+
+        Other packed files can be read with rwops(), e.g. a compressed
+        sound effect: Sound sound(pack.rwops("sounds/boom.ogg")).
+
+        Small images are packed into atlas pages. pack.image() still gives
+        each of them its own texture. To draw from the shared page instead:
+
+        Rect src;
+        const PackEntry* page = pack.atlas("images/galaxian/GalaxianRedAlien.gif", src);
+        Image sheet = pack.image(page->name, window);
+        window.put_image(sheet, src, dst);
+
+        If an asset is missing an error is printed and an empty object is
+        returned.
+
+    *************************************************************************/
+
+    class Pack
+    {
+    public:
+        Pack(const std::string& filename);
+        Pack(const Pack& other) = delete;
+        Pack& operator=(const Pack& other) = delete;
+        bool is_open() const;
+        size_t size() const;
+        const PackEntry* find(const std::string& name) const;
+        const uint8_t* data(const PackEntry& entry) const;
+        Image image(const std::string& name, Window& window) const;
+        Font font(const std::string& name, size_t size) const;
+        Sound sound(const std::string& name) const;
+        Music music(const std::string& name) const;
+        SDL_RWops* rwops(const std::string& name) const;
+        const PackEntry* atlas(const std::string& name, Rect& src) const;
+    private:
+        MappedFile _file;
+        const PackEntry* _entries;
+        uint32_t _count;
+        std::unordered_map<std::string, const PackEntry*> _index;
+
+        const PackEntry* _get(const std::string& name, PackType type) const;
+        Span _span(const PackEntry& entry) const;
+    };
+}
+
+#endif
@@ -0,0 +1,96 @@
+/*
+ * SDLX, a SDL graphics library for CS students.
+ * Copyright (C) 2017, Seth Kasmann, Yihsiang Liow
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PCM_H
+#define PCM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace sdlx {
+
+    struct AudioConfig;
+
+    // How WAV samples are resampled when they are loaded. See
+    // SDL_HINT_AUDIO_RESAMPLING_MODE.
+    enum Resample
+    {
+        RESAMPLE_DEFAULT,   // SDL's default, or the environment's hint
+        RESAMPLE_FAST,      // linear
+        RESAMPLE_MEDIUM,
+        RESAMPLE_BEST       // slowest to load, no cost when playing
+    };
+
+    typedef std::shared_ptr<const std::vector<uint8_t> > PcmBuffer;
+
+    // Converts samples to the frequency, format and channels of to.
+    bool convert_pcm(const void* pcm, size_t bytes, int frequency,
+                     uint16_t format, int channels, const AudioConfig& to,
+                     std::vector<uint8_t>& out);
+
+    // Decodes a whole sound file to samples in the format of to.
+    bool decode_pcm(const char* filename, const AudioConfig& to,
+                    std::vector<uint8_t>& out);
+
+    /*************************************************************************
+
+        A PcmCache keeps sound files decoded and converted to the format of
+        the audio device, so nothing is converted while the sound plays and
+        a file used by many Sounds is decoded only once.
+
+        You do not make one. Every Sound, SoundBank and decoded Music loads
+        through the one the audio device owns:
+
+        std::cout << context().audio().pcm().bytes() << " bytes of samples\n";
+
+        Like the ImageCache (see cache.h), samples are kept while something
+        uses them. The format is part of the key, so samples loaded before
+        the device was reopened with another format are not reused.
+
+        WAV files are resampled with the quality set by
+        AudioConfig::resample. Other files (OGG, FLAC ...) are decoded and
+        resampled by SDL_mixer, which ignores it. The quality only makes a
+        difference when SDL was built with libsamplerate; otherwise SDL
+        uses its own resampler for every mode.
+
+        It can be used from any thread.
+
+    *************************************************************************/
+
+    class PcmCache
+    {
+    public:
+        PcmCache();
+        PcmCache(const PcmCache& other) = delete;
+        PcmCache& operator=(const PcmCache& other) = delete;
+        PcmBuffer get(const std::string& filename, const AudioConfig& spec);
+        size_t size() const;
+        size_t bytes() const;
+        void purge();
+    private:
+        mutable std::mutex _mutex;
+        std::map<std::string, std::weak_ptr<const std::vector<uint8_t> > > _buffers;
+    };
+}
+
+#endif
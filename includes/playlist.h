@@ -0,0 +1,127 @@
+/*
+ * SDLX, a SDL graphics library for CS students.
+ * Copyright (C) 2017, Seth Kasmann, Yihsiang Liow
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PLAYLIST_H
+#define PLAYLIST_H
+
+#include <mutex>
+#include <string>
+#include <vector>
+#include "pcm.h"
+#include "pool.h"
+
+class Mix_Chunk;
+
+namespace sdlx {
+
+    /*************************************************************************
+
+        Class Playlist
+
+        A Playlist plays music tracks one after the other and crossfades
+        between them. Each track is decoded on a background thread while
+        the one before it plays, so changing tracks never makes the game
+        loop wait.
+
+        USAGE:
+        Playlist music;
+        music.add("sounds/GameLoop.ogg");
+        music.add("sounds/Boss.ogg");
+        music.set_crossfade(3000);          // ms, default 2000
+        music.play();
+
+        while (...)
+        {
+            music.update();                 // once per frame
+            ...
+        }
+
+        music.next();                       // e.g. on a scene change
+
+        play() and next() return at once. The track starts in the first
+        update() after it is decoded, crossfading from the one that plays.
+        A track also loops with no gap until the next one is ready, so
+        the music never stops for a slow disk. A Playlist with a single
+        track loops it forever, without a gap.
+
+        With set_loop(false) the music stops after the last track.
+
+        Tracks are decoded completely before they play (see MUSIC_DECODED
+        in sound.h), so about two tracks are in memory at a time. The
+        Playlist uses two mixer channels that are kept out of the
+        VoicePool (see AUDIO_RESERVED in audio.h); only one Playlist
+        should play at a time.
+
+        Use a Playlist from one thread.
+
+    *************************************************************************/
+
+    class Playlist
+    {
+    public:
+        Playlist();
+        ~Playlist();
+        Playlist(const Playlist& other) = delete;
+        Playlist& operator=(const Playlist& other) = delete;
+        void add(const std::string& filename);
+        void clear();
+        size_t size() const;
+        void set_crossfade(int ms);
+        void set_loop(bool loop);
+        void set_volume(int volume);
+        void play(int track=0);
+        void next();
+        void stop(int fade_ms=0);
+        void update();
+        int current() const;
+        bool is_playing() const;
+    private:
+        struct Track
+        {
+            int index;
+            int channel;
+            PcmBuffer pcm;
+            Mix_Chunk* chunk;
+            uint32_t start;
+            uint32_t length;    // ms
+        };
+
+        std::vector<std::string> _files;
+        Track _playing;
+        Track _fading;
+        int _pending;           // track to start when it is decoded
+        int _crossfade;
+        bool _loop;
+        int _volume;
+        bool _audio;
+
+        std::mutex _mutex;      // guards the decoded track
+        int _want;
+        bool _ready;
+        PcmBuffer _decoded;
+        int _generation;        // bumped by clear() to drop late decodes
+        ThreadPool _pool;
+
+        int _following(int track) const;
+        void _prefetch(int track);
+        void _start();
+        void _free(Track& track);
+    };
+}
+
+#endif
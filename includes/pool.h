@@ -0,0 +1,74 @@
+/*
+ * SDLX, a SDL graphics library for CS students.
+ * Copyright (C) 2017, Seth Kasmann, Yihsiang Liow
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef POOL_H
+#define POOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sdlx {
+
+    /*************************************************************************
+
+        A ThreadPool runs jobs on a fixed set of background threads. Jobs
+        start in the order they were submitted.
+
+        With threads=0 the pool uses one thread per CPU core, minus one for
+        the thread that draws.
+
+        The destructor waits for every submitted job to finish.
+
+        USAGE:
+
+        ThreadPool pool;
+        pool.submit([] { decode_something(); });
+        pool.wait();
+
+    *************************************************************************/
+
+    class ThreadPool
+    {
+    public:
+        ThreadPool(int threads=0);
+        ~ThreadPool();
+        void submit(const std::function<void()>& job);
+        void wait();
+        int size() const;
+    private:
+        std::vector<std::thread> _threads;
+        std::deque<std::function<void()> > _jobs;
+        std::mutex _mutex;
+        std::condition_variable _ready;
+        std::condition_variable _idle;
+        int _running;
+        bool _quit;
+
+        void _run();
+
+        // A pool should not be copied.
+        ThreadPool(const ThreadPool& p);
+        void operator=(const ThreadPool& p);
+    };
+}
+
+#endif
@@ -0,0 +1,101 @@
+/*
+ * SDLX, a SDL graphics library for CS students.
+ * Copyright (C) 2017, Seth Kasmann, Yihsiang Liow
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <cstdint>
+#include <string>
+
+namespace sdlx {
+
+    /*************************************************************************
+
+        Profiling Zones
+
+        A zone measures how long a block of code takes. Put SDLX_ZONE at the
+        top of a block and the time from that line to the end of the block
+        is recorded, together with the frame it happened in.
+
+        Zones are only compiled in when SDLX_PROFILE is defined (see the
+        "prof" target in the makefile). Otherwise SDLX_ZONE and SDLX_FRAME
+        expand to nothing and cost nothing.
+
+        Each thread records into its own ring buffer, so zones never take a
+        lock. A buffer holds the last PROFILE_CAPACITY zones of its thread;
+        older zones are overwritten. When a thread exits, its zones are kept
+        until the next new thread takes over the buffer.
+
+        The library marks the end of each frame in Window::draw(). You can
+        mark frames yourself with SDLX_FRAME() if you do not use a Window.
+
+        USAGE:
+
+        void update()
+        {
+            SDLX_ZONE("update");
+            // ... work ...
+        }
+
+        // Later, write frames 100 to 200 to a file. Open the file in
+        // chrome://tracing or https://ui.perfetto.dev to see the timeline.
+        profile_write("trace.json", 100, 200);
+
+    *************************************************************************/
+
+    static const uint32_t PROFILE_CAPACITY = 1 << 16;
+
+    class Zone
+    {
+    public:
+        Zone(const char* name);
+        ~Zone();
+    private:
+        const char* _name;
+        uint64_t _begin;
+        uint32_t _frame;
+
+        // A zone should not be copied.
+        Zone(const Zone& z);
+        void operator=(const Zone& z);
+    };
+
+    // Marks the end of the current frame and returns the new frame index.
+    uint32_t profile_frame();
+
+    // The index of the frame currently being recorded.
+    uint32_t profile_frame_index();
+
+    // Writes every zone recorded in frames first .. last (inclusive) as
+    // Chrome trace_event JSON. Returns false if the file could not be
+    // written. Call this between frames; zones recorded while writing may
+    // be missing from the file.
+    bool profile_write(const std::string& filename, uint32_t first, uint32_t last);
+}
+
+#ifdef SDLX_PROFILE
+#define SDLX_ZONE_JOIN2(a, b) a##b
+#define SDLX_ZONE_JOIN(a, b) SDLX_ZONE_JOIN2(a, b)
+#define SDLX_ZONE(name) sdlx::Zone SDLX_ZONE_JOIN(_sdlx_zone_, __LINE__)(name)
+#define SDLX_FRAME() sdlx::profile_frame()
+#else
+#define SDLX_ZONE(name)
+#define SDLX_FRAME()
+#endif
+
+#endif
@@ -0,0 +1,59 @@
+/*
+ * SDLX, a SDL graphics library for CS students.
+ * Copyright (C) 2017, Seth Kasmann, Yihsiang Liow
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RWOPS_H
+#define RWOPS_H
+
+#include <cstdint>
+#include "types.h"
+
+class SDL_RWops;
+
+namespace sdlx {
+
+    /*************************************************************************
+
+        Helpers that make SDL_RWops for Sound and Music (see sound.h) to
+        read from, so a file inside a larger archive can be played without
+        copying it out first.
+
+        rw_from_span() reads memory in place, e.g. a MappedFile (see
+        mapped.h) or an embedded file:
+
+        MappedFile file("music.pak");
+        Span song = { file.data() + offset, size };
+        Music music(rw_from_span(song));
+
+        rw_from_range() reads size bytes starting at offset of a file, as if
+        they were a file of their own. Nothing is mapped or read up front:
+
+        Music music(rw_from_range("music.pak", offset, size));
+
+        or of another SDL_RWops, which is closed with the new one.
+
+        They return NULL, and say why, if the file cannot be opened or the
+        range is not inside it.
+
+    *************************************************************************/
+
+    SDL_RWops* rw_from_span(Span span);
+    SDL_RWops* rw_from_range(const char* filename, int64_t offset, int64_t size);
+    SDL_RWops* rw_from_range(SDL_RWops* file, int64_t offset, int64_t size);
+}
+
+#endif
@@ -20,44 +20,33 @@
 #define SDLX_H
 
 #include "constants.h"
+#include "context.h"
+#include "audio.h"
 #include "event.h"
 #include "image.h"
 #include "sound.h"
 #include "window.h"
 #include "device.h"
+#include "profile.h"
+#include "hud.h"
+#include "capture.h"
+#include "pool.h"
+#include "loader.h"
+#include "cache.h"
+#include "mapped.h"
+#include "pack.h"
+#include "files.h"
+#include "voice.h"
+#include "mixer.h"
+#include "pcm.h"
+#include "playlist.h"
+#include "rwops.h"
+#include "spatial.h"
+#include "effects.h"
+#include "bank.h"
 
 namespace sdlx
 {
-    struct Initializer
-    {
-        Initializer()
-        {
-            const int IMG_FLAGS = IMG_INIT_JPG | IMG_INIT_PNG | IMG_INIT_TIF;
-
-            const int MIX_FLAGS = MIX_INIT_FLAC | MIX_INIT_OGG;
-
-            if (SDL_Init(SDL_INIT_EVERYTHING) != 0)
-                std::cout << "SDL_Init: " << SDL_GetError() << std::endl;
-            if (TTF_Init() == -1)
-                std::cout << "TTF_Init: " << TTF_GetError() << std::endl;
-            if ((IMG_Init(IMG_FLAGS) & IMG_FLAGS) != IMG_FLAGS)
-                std::cout << "Failed to initialize JPG, PNG, & TIF support." 
-                          << std::endl << "IMG_Init: " << IMG_GetError()
-                          << std::endl;
-            if ((Mix_Init(MIX_FLAGS) & MIX_FLAGS) != MIX_FLAGS)
-                std::cout << "Failed to initialize FLAG, MOD, MP3, & OGG support." 
-                          << std::endl <<"MIX_Init: " << Mix_GetError() 
-                          << std::endl;
-        }
-        ~Initializer()
-        {
-            while (Mix_Init(0)) Mix_Quit();
-            TTF_Quit();
-            IMG_Quit();
-            SDL_Quit();     
-        }
-    }; 
-
     inline int get_ticks()
     {
         return SDL_GetTicks();
@@ -67,8 +56,6 @@ namespace sdlx
     {
         SDL_Delay(t);
     }
-
-    static Initializer sdlx_init;
 }
 
 #endif
\ No newline at end of file
@@ -19,8 +19,16 @@
 #ifndef SOUND_H
 #define SOUND_H
 
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "pcm.h"
+#include "types.h"
+#include "voice.h"
+
 class Mix_Chunk;
 class _Mix_Music;
+class SDL_RWops;
 
 namespace sdlx {
 
@@ -36,18 +44,85 @@ namespace sdlx {
         sound.play();
         delay(5000);
 
+        The file is decoded and converted to the audio device's format
+        when the Sound is made, and shared with every other Sound of the
+        same file (see pcm.h).
+
+        play() returns the voice the sound plays on, or -1 if it was not
+        played. How voices are shared between sounds is set per Sound (see
+        voice.h):
+            - set_priority(p) sounds with a higher priority cut off
+              sounds with a lower one when every voice is busy (default 0)
+            - set_limit(n)    at most n voices play this sound; 0 for no
+              limit (default 4)
+            - set_coalesce(ms) playing it again within ms does nothing
+              (default 10)
+            - set_volume(v)   0 .. 128 (default 128)
+
+        play_at(x, y) plays the sound at a position in the game world,
+        quieter and panned by where it is from the listener (see
+        spatial.h).
+
+        A Sound can be moved (e.g. into a std::vector) but not copied.
+
+        A Sound can also be made from a sound file held in memory, e.g. one
+        embedded in the program (see tools/embed.cpp):
+
+        #include "embedded.h"
+        Sound sound(assets::sounds_laser_wav);
+
+        or from an SDL_RWops, which the Sound closes (see rwops.h):
+
+        Sound sound(rw_from_range("sounds.pak", offset, size));
+
+        or from decoded PCM samples already in memory, e.g. from an asset
+        pack (see pack.h):
+
+        Sound sound(pcm, bytes, 44100, AUDIO_S16LSB, 2);
+
+        If the samples are in the format the audio device was opened with
+        they are played straight from that memory, which must then stay
+        valid for as long as the Sound is used. Otherwise they are converted
+        once into a buffer owned by the Sound.
+
     *************************************************************************/
     class Sound
     {
     public:
         Sound(const char* filename=nullptr);
+        Sound(Span file);
+        Sound(SDL_RWops* file);
+        Sound(const void* pcm, size_t bytes, int frequency, uint16_t format,
+              int channels);
+        Sound(Sound&& other);
+        Sound& operator=(Sound&& other);
+        Sound(const Sound& other) = delete;
+        Sound& operator=(const Sound& other) = delete;
         ~Sound();
         void on();
         void off();
-        void play();
+        int play();
+        int play_at(float x, float y);
+        void set_priority(int priority);
+        void set_limit(int limit);
+        void set_coalesce(uint32_t ms);
+        void set_volume(int volume);
     private:
         Mix_Chunk* sample;
         bool _on;
+        VoiceParams _params;
+        bool _audio;    // true while this object holds the shared audio device
+        std::vector<uint8_t> _pcm;  // converted samples, if any
+        PcmBuffer _shared;          // samples of a file, shared
+
+        void _open();
+        void _free();
+    };
+
+    enum MusicMode
+    {
+        MUSIC_STREAM,       // decode while playing
+        MUSIC_DECODED       // decode all of it when loaded
     };
 
     /*************************************************************************
@@ -80,14 +155,48 @@ namespace sdlx {
         music.stop();
         delay(100);
 
+        Music can also be played from a file held in memory:
+
+        Music music(assets::sounds_GameLoop_ogg);
+
+        or from any SDL_RWops, e.g. a song stored inside a larger file (see
+        rwops.h and Pack::music() in pack.h):
+
+        Music music(rw_from_range("music.pak", offset, size));
+
+        The Music closes the SDL_RWops when it is freed.
+
+        Music is decoded while it plays, reading the file or memory a bit
+        at a time, so the memory must stay valid for as long as the Music
+        is used. Nothing is copied.
+
+        Decoding OGG or MP3 while playing costs time in every mixing
+        callback. Short music that loops can be decoded once, when it is
+        loaded, and then costs no more than a Sound:
+
+        Music loop("sounds/GameLoop.ogg", MUSIC_DECODED);
+        loop.play();
+
+        Decoded music takes frequency * channels * bytes per sample of
+        memory per second, about 10 MB a minute at 44100 Hz in float.
+        It plays on a channel of its own (see AUDIO_RESERVED in audio.h).
+
+        A Music can be moved but not copied.
+
     *************************************************************************/
 
     class Music
     {
     public:
-        Music(const char* filename=nullptr);
+        Music(const char* filename=nullptr, MusicMode mode=MUSIC_STREAM);
+        Music(Span file);
+        Music(SDL_RWops* file);
+        Music(Music&& other);
+        Music& operator=(Music&& other);
+        Music(const Music& other) = delete;
+        Music& operator=(const Music& other) = delete;
         ~Music();
-        void load(const char* filename=nullptr);
+        void load(const char* filename=nullptr, MusicMode mode=MUSIC_STREAM);
         void free();
         void on();
         void off();
@@ -95,7 +204,14 @@ namespace sdlx {
         void stop();
     private:
         _Mix_Music* sample;
+        Mix_Chunk* _decoded;        // MUSIC_DECODED
+        PcmBuffer _pcm;
         bool _on;
+        bool _audio;    // true while this object holds the shared audio device
+
+        void _open();
+        void _close();
+        void _load(const char* filename, MusicMode mode);
     };
 
 }
@@ -0,0 +1,118 @@
+/*
+ * SDLX, a SDL graphics library for CS students.
+ * Copyright (C) 2017, Seth Kasmann, Yihsiang Liow
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SPATIAL_H
+#define SPATIAL_H
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include "voice.h"
+
+class Mix_Chunk;
+
+namespace sdlx {
+
+    class AudioDevice;
+
+    /*************************************************************************
+
+        Class Spatial
+
+        Plays sounds at a position in the game world. Sounds get quieter
+        away from the listener and are panned left or right by where they
+        are, like in a top-down or side view.
+
+        USAGE:
+        Spatial& spatial = context().audio().spatial();
+        spatial.set_range(100, 800);        // full volume up to 100, silent at 800
+
+        Sound engine("sounds/engine.wav");
+        int voice = engine.play_at(ship.x, ship.y);
+
+        while (...)
+        {
+            spatial.set_listener(player.x, player.y);
+            spatial.move(voice, ship.x, ship.y);
+            spatial.update();               // once per frame
+            ...
+        }
+
+        update() works out the volume and pan of every playing sound in a
+        single pass and only tells the mixer about the ones that changed.
+        Sounds that have stopped are forgotten. play_at() sets the new
+        sound's position right away, so it never starts in the wrong
+        place.
+
+        Volume falls linearly from full at the first distance of
+        set_range() to silent at the second (default 100 and 1000). Pan is
+        the sideways part of the direction to the sound.
+
+        Use it from one thread.
+
+    *************************************************************************/
+
+    class Spatial
+    {
+    public:
+        Spatial(AudioDevice& device);
+        Spatial(const Spatial& other) = delete;
+        Spatial& operator=(const Spatial& other) = delete;
+        void set_listener(float x, float y);
+        void set_range(float full, float silent);
+        int play(Mix_Chunk* chunk, const VoiceParams& params, float x, float y);
+        void move(int voice, float x, float y);
+        void update();
+        int size() const;
+        void clear();
+    private:
+        struct Emitter
+        {
+            int voice;
+            Mix_Chunk* chunk;
+            int volume;
+            bool native;
+            uint8_t left, right, distance;  // last sent to SDL_mixer
+            int native_volume;              // .. to the NativeMixer
+            int native_pan;                 // in 1/64
+        };
+
+        AudioDevice& _device;
+        std::mutex _mutex;
+        float _listener_x;
+        float _listener_y;
+        float _full;        // distance up to which sounds are at full volume
+        float _silent;      // distance from which they are not heard
+
+        // One entry per playing sound, kept as arrays for the batched pass.
+        std::vector<Emitter> _emitters;
+        std::vector<float> _x;
+        std::vector<float> _y;
+        std::vector<float> _gain;
+        std::vector<float> _pan;
+
+        bool _playing(const Emitter& e) const;
+        void _remove(size_t i);
+        void _compute(size_t begin, size_t end);
+        void _level(float x, float y, float& gain, float& pan) const;
+        void _apply(size_t i);
+        static void _place(int channel, void* emitter);
+    };
+}
+
+#endif
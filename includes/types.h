@@ -19,6 +19,7 @@
 #ifndef TYPES_H
 #define TYPES_H
 
+#include <cstddef>
 #include <cstdint>
 
 class SDL_Point;
@@ -34,6 +35,14 @@ namespace sdlx {
     typedef int32_t s32;
     typedef uint8_t u8;
 
+    // A block of memory that is not owned, e.g. an embedded file (see
+    // tools/embed.cpp) or an asset inside a pack.
+    struct Span
+    {
+        const void* data;
+        size_t size;
+    };
+
     struct Circle
     {
         int16_t x;
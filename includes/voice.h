@@ -0,0 +1,135 @@
+/*
+ * SDLX, a SDL graphics library for CS students.
+ * Copyright (C) 2017, Seth Kasmann, Yihsiang Liow
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef VOICE_H
+#define VOICE_H
+
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+class Mix_Chunk;
+
+namespace sdlx {
+
+    // What to do when a sound is played and every voice is busy.
+    enum Steal
+    {
+        STEAL_NONE,         // do not play the new sound
+        STEAL_OLDEST,       // stop the voice that has played the longest
+        STEAL_QUIETEST      // stop the quietest voice
+    };
+
+    // Run by the mixer on every voice the pool starts, after the voice is
+    // mixed. Same signature as SDL_mixer's Mix_EffectFunc_t.
+    typedef void (*VoiceEffect)(int channel, void* stream, int bytes, void* data);
+
+    // Run by VoicePool::play() right after a voice starts, before the audio
+    // thread can mix it, e.g. to set its panning (see spatial.h).
+    typedef void (*VoiceSetup)(int channel, void* data);
+
+    // How a sample is played. Every Sound has one (see sound.h).
+    struct VoiceParams
+    {
+        VoiceParams();
+        int priority;       // higher is more important
+        int limit;          // most voices playing this sample, 0 for no limit
+        uint32_t coalesce;  // ms in which playing it again does nothing
+        int volume;         // 0 .. 128
+    };
+
+    /*************************************************************************
+
+        Class VoicePool
+
+        The pool decides which mixer channel (voice) plays a sound. Sound
+        uses it for every play(). A sound is refused or another voice is
+        cut off instead of failing silently or piling up:
+
+            - A sample played again within its coalesce time is not played
+              again. Ten lasers fired in the same frame make one sound.
+            - A sample that already plays on limit voices restarts its
+              oldest voice instead of taking another one.
+            - When every voice is busy, the pool stops a voice with the
+              same or a lower priority, the oldest or the quietest
+              depending on set_steal(), and gives it to the new sound. If
+              every busy voice has a higher priority the new sound is not
+              played.
+
+        USAGE:
+        VoicePool& voices = context().audio().voices();
+        voices.set_steal(STEAL_QUIETEST);
+
+        Sound explosion("sounds/explosion.wav");
+        explosion.set_priority(10);         // never cut off by a laser
+        Sound laser("sounds/laser.wav");
+        laser.set_limit(3);
+
+        The number of voices is AudioConfig::voices (see audio.h). The
+        first reserved channels of resize() are never used by the pool. With
+        timing on, the AudioDevice uses set_effect() to see which voices each
+        mixing callback mixes (see AudioStats). An effect makes SDL_mixer
+        copy the voice's buffer on every callback, so none is set otherwise.
+
+    *************************************************************************/
+
+    class VoicePool
+    {
+    public:
+        VoicePool();
+        VoicePool(const VoicePool& other) = delete;
+        VoicePool& operator=(const VoicePool& other) = delete;
+        void resize(int voices, int reserved=0);
+        int size() const;
+        void set_steal(Steal steal);
+        void set_effect(VoiceEffect effect, void* data);
+        int play(Mix_Chunk* chunk, const VoiceParams& params,
+                 VoiceSetup setup=nullptr, void* data=nullptr);
+        void stop(Mix_Chunk* chunk);
+        int active() const;
+        int playing(Mix_Chunk* chunk) const;
+        uint32_t stolen() const;
+        uint32_t refused() const;
+        uint32_t coalesced() const;
+    private:
+        struct Voice
+        {
+            Mix_Chunk* chunk;
+            int priority;
+            int volume;
+            uint32_t start;
+        };
+
+        mutable std::mutex _mutex;
+        std::vector<Voice> _voices;
+        int _reserved;
+        std::unordered_map<Mix_Chunk*, uint32_t> _last;
+        Steal _steal;
+        VoiceEffect _effect;
+        void* _effect_data;
+        uint32_t _stolen;
+        uint32_t _refused;
+        uint32_t _coalesced;
+
+        bool _busy(int channel) const;
+        int _choose(Mix_Chunk* chunk, const VoiceParams& params);
+    };
+}
+
+#endif
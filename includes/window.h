@@ -24,6 +24,7 @@
 
 class SDL_Window;
 class SDL_Renderer;
+class SDL_Surface;
 
 namespace sdlx {
 
@@ -32,15 +33,75 @@ namespace sdlx {
     static const int DEFAULT_HEIGHT = 480;
     
     class Image;
+    class Hud;
+    class Capture;
+
+    // What a Window drew during one frame. primitives counts points, line
+    // segments, rectangles, circles, ellipses, polygons and images.
+    struct RenderStats
+    {
+        RenderStats()
+            : draw_calls(0), primitives(0)
+        {}
+        uint32_t draw_calls;
+        uint32_t primitives;
+    };
+
+    /*************************************************************************
+
+        Offscreen windows
+
+        Pass OFFSCREEN instead of a name to get a Window that draws into
+        memory instead of onto the screen. Nothing is shown, there is no
+        vsync, and draw() returns as soon as the frame is finished, so you
+        can render frames back to back as fast as possible. Use it for
+        thumbnails, videos or tests on a machine without a display.
+
+        get_pixels() gives you the frame directly, with no copy. The pixels
+        are 32-bit ARGB, get_pitch() bytes per row, and are valid after
+        draw().
+
+        USAGE:
+
+        Window window(320, 240, OFFSCREEN);
+        window.clear(BLUE);
+        window.put_circle(160, 120, 50, RED);
+        window.draw();
+        const uint32_t* pixels = (const uint32_t*) window.get_pixels();
+
+        Window properties that only make sense on screen (hide, show,
+        fullscreen, set_size) do nothing for an offscreen window.
+
+    *************************************************************************/
+
+    struct Offscreen {};
+    static const Offscreen OFFSCREEN = Offscreen();
 
     class Window
     {
     public:
         Window(const std::string& name="CISS 245");
         Window(int width, int height, const std::string& name="CISS 245");
+        Window(int width, int height, Offscreen);
         ~Window();
+
+        // A window can be moved but should not be copied.
+        Window(Window&& other);
+        Window& operator=(Window&& other);
+        Window(const Window& other) = delete;
+        Window& operator=(const Window& other) = delete;
+
         SDL_Renderer* get_renderer();
 
+        //------------------------------------------------------------------------
+        // Offscreen pixels (see above)
+        //------------------------------------------------------------------------
+
+        bool offscreen() const;
+        SDL_Surface* get_surface();
+        void* get_pixels();
+        int get_pitch() const;
+
 
         //------------------------------------------------------------------------
         // Window Properties
@@ -60,6 +121,23 @@ namespace sdlx {
         void clear(const Color& c=BLACK);
         void draw();
 
+        //------------------------------------------------------------------------
+        // Performance overlay (see hud.h)
+        //------------------------------------------------------------------------
+
+        void show_hud(bool on=true);
+        void toggle_hud();
+        bool hud_visible() const;
+        const RenderStats& get_stats() const;
+
+        //------------------------------------------------------------------------
+        // Frame capture (see capture.h)
+        //------------------------------------------------------------------------
+
+        void capture_async(const std::string& filename="");
+        void capture_flush();
+        uint32_t captures_dropped() const;
+
         //------------------------------------------------------------------------
         // Pixel drawing
         //------------------------------------------------------------------------
@@ -140,12 +218,18 @@ namespace sdlx {
         bool _closed;
         SDL_Window* _window;
         SDL_Renderer* _renderer;
-
-        // A window should not be copied.
-        Window(const Window& w);
-        void operator=(const Window& w);
-        
+        SDL_Surface* _surface;
+        Hud* _hud;
+        Capture* _capture;
+        bool _hud_on;
+        uint64_t _last_draw;
+        RenderStats _stats;
+        RenderStats _last_stats;
+
+        void _destroy();
         void _init(const std::string& name, int width, int height);
+        void _init_offscreen(int width, int height);
+        void _tally(int primitives);
         int _set_color(int r, int g, int b, int a);
         int _put_point(int x, int y);
         int _put_line(int x0, int y0, int x1, int y1);
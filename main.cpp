@@ -704,6 +704,11 @@ void fancyhelloworld()
                 quit = true;
                 break;
             }
+            else if (event.type() == KEYDOWN && event.key() == KEY_H)
+            {
+                // Press H to show or hide the performance overlay.
+                window.toggle_hud();
+            }
         }
 
         int start = get_ticks();
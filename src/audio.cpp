@@ -0,0 +1,524 @@
+/*
+ * SDLX, a SDL graphics library for CS students.
+ * Copyright (C) 2017, Seth Kasmann, Yihsiang Liow
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include "audio.h"
+#include "context.h"
+#include "sdllib.h"
+
+namespace sdlx {
+
+    namespace {
+
+        uint64_t now_ns()
+        {
+            using namespace std::chrono;
+            return duration_cast<nanoseconds>(
+                steady_clock::now().time_since_epoch()).count();
+        }
+
+        // Replaces value with the environment variable name, if it is set.
+        void override(int& value, const char* name)
+        {
+            const char* s = SDL_getenv(name);
+            if (s != NULL && std::atoi(s) > 0)
+                value = std::atoi(s);
+        }
+
+        // Listens for the first mixed buffer that is not silent.
+        struct Probe
+        {
+            std::atomic<uint64_t> heard;
+        };
+
+        void probe(void* data, uint8_t* stream, int bytes)
+        {
+            Probe* p = static_cast<Probe*>(data);
+            if (p->heard.load(std::memory_order_relaxed) != 0)
+                return;
+            for (int i = 0; i < bytes; ++i)
+            {
+                if (stream[i] != 0)
+                {
+                    p->heard.store(now_ns());
+                    return;
+                }
+            }
+        }
+    }
+
+    AudioConfig::AudioConfig()
+    : frequency(44100), format(AUDIO_S16SYS), channels(2), chunk(512),
+      voices(16), native(false), resample(RESAMPLE_DEFAULT)
+    {}
+
+    AudioDevice::AudioDevice()
+    : _spatial(*this), _users(0), _open(false), _timing(false),
+      _tap_count(0), _callbacks(0), _last_ns(0),
+      _period_ns(0), _jitter_ns(0), _loopback_ms(0.0), _mix_start_ns(0), _mixed(0),
+      _stat_callbacks(0), _mix_ns(0), _mix_total_ns(0), _mix_max_ns(0),
+      _last_period_ns(0), _overruns(0), _underruns(0), _voices_mixed(0),
+      _peak(0.0f), _peak_max(0.0f), _reset(false), _head(0), _first(0)
+    {}
+
+    AudioDevice::~AudioDevice()
+    {
+        close();
+    }
+
+    void AudioDevice::configure(const AudioConfig& config)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _config = config;
+    }
+
+    const AudioConfig& AudioDevice::config() const
+    {
+        return _config;
+    }
+
+    AudioConfig AudioDevice::spec() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _open ? _spec : _config;
+    }
+
+    bool AudioDevice::is_open() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _open;
+    }
+
+    int AudioDevice::users() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _users;
+    }
+
+    VoicePool& AudioDevice::voices()
+    {
+        return _voices;
+    }
+
+    NativeMixer& AudioDevice::native()
+    {
+        return _native;
+    }
+
+    PcmCache& AudioDevice::pcm()
+    {
+        return _pcm;
+    }
+
+    Spatial& AudioDevice::spatial()
+    {
+        return _spatial;
+    }
+
+    EffectChain& AudioDevice::effects()
+    {
+        return _effects;
+    }
+
+    int AudioDevice::play(Mix_Chunk* chunk, const VoiceParams& params)
+    {
+        if (_native.is_open())
+            return _native.play(chunk, params);
+        return _voices.play(chunk, params);
+    }
+
+    void AudioDevice::stop(Mix_Chunk* chunk)
+    {
+        if (_native.is_open())
+            _native.stop(chunk);
+        else
+            _voices.stop(chunk);
+    }
+
+    bool AudioDevice::acquire()
+    {
+        if (!context().require(INIT_AUDIO))
+            return false;
+        // Without FLAC or OGG support, WAV files still play.
+        context().require(INIT_MIXER);
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_open)
+        {
+            AudioConfig c = _config;
+            override(c.frequency, "SDLX_AUDIO_FREQUENCY");
+            override(c.chunk, "SDLX_AUDIO_CHUNK");
+            // Set every time, so an earlier "best" does not outlive the
+            // configuration that asked for it.
+            const char* MODES[] = { "default", "fast", "medium", "best" };
+            SDL_SetHint(SDL_HINT_AUDIO_RESAMPLING_MODE, MODES[c.resample]);
+            // The native mixer adds float stereo voices to SDL_mixer's
+            // buffers, so that format must not change. SDL converts if the
+            // hardware wants another one.
+            int changes = SDL_AUDIO_ALLOW_FREQUENCY_CHANGE | SDL_AUDIO_ALLOW_CHANNELS_CHANGE;
+            if (c.native)
+            {
+                c.format = AUDIO_F32SYS;
+                c.channels = 2;
+                changes = 0;
+            }
+            if (Mix_OpenAudioDevice(c.frequency, c.format, c.channels, c.chunk,
+                                    NULL, changes) != 0)
+            {
+                std::cout << "Error in AudioDevice: Mix_OpenAudioDevice: "
+                          << Mix_GetError() << std::endl;
+                return false;
+            }
+            Mix_QuerySpec(&c.frequency, &c.format, &c.channels);
+            _spec = c;
+            _open = true;
+            _callbacks = 0;
+            _last_ns = 0;
+            _period_ns = 0;
+            _jitter_ns = 0;
+            _reset = true;
+            _first = _head.load();
+            _mixed = 0;
+            _voices.resize(c.voices, AUDIO_RESERVED);
+            _voices.set_effect(_timing ? _voice_mixed : NULL, this);
+            Mix_SetPostMix(_post_mix, this);
+            if (c.native)
+                _native.open(c.frequency);
+            _effects.attach(*this, c);
+        }
+        ++_users;
+        return true;
+    }
+
+    void AudioDevice::release()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_users > 0 && --_users == 0 && _open)
+        {
+            _spatial.clear();
+            _effects.detach();
+            _native.close();
+            Mix_SetPostMix(NULL, NULL);
+            _voices.resize(0);
+            Mix_CloseAudio();
+            _open = false;
+        }
+    }
+
+    void AudioDevice::close()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_open)
+        {
+            Mix_HaltMusic();
+            _spatial.clear();
+            _effects.detach();
+            _native.close();
+            Mix_SetPostMix(NULL, NULL);
+            _voices.resize(0);
+            Mix_CloseAudio();
+            _open = false;
+        }
+        _users = 0;
+    }
+
+    // _taps_mutex keeps game threads apart. Mix_LockAudio() keeps the
+    // callback out while the array changes, so the callback reads it
+    // without a lock.
+    void AudioDevice::add_post_mix(PostMix f, void* data)
+    {
+        std::lock_guard<std::mutex> lock(_taps_mutex);
+        if (_tap_count == AUDIO_TAPS)
+        {
+            std::cout << "Error in AudioDevice::add_post_mix(): More than "
+                      << AUDIO_TAPS << " functions.\n";
+            return;
+        }
+        Mix_LockAudio();
+        _taps[_tap_count++] = std::make_pair(f, data);
+        Mix_UnlockAudio();
+    }
+
+    void AudioDevice::remove_post_mix(PostMix f, void* data)
+    {
+        std::lock_guard<std::mutex> lock(_taps_mutex);
+        for (int i = 0; i < _tap_count; ++i)
+        {
+            if (_taps[i].first == f && _taps[i].second == data)
+            {
+                Mix_LockAudio();
+                for (int j = i + 1; j < _tap_count; ++j)
+                    _taps[j - 1] = _taps[j];
+                --_tap_count;
+                Mix_UnlockAudio();
+                return;
+            }
+        }
+    }
+
+    AudioLatency AudioDevice::latency() const
+    {
+        const AudioConfig s = spec();
+        AudioLatency l;
+        l.buffer_ms = 1000.0 * s.chunk / s.frequency;
+        // One buffer is being mixed while the one before it plays.
+        l.output_ms = 2.0 * l.buffer_ms;
+        l.period_ms = _period_ns / 1e6;
+        l.jitter_ms = _jitter_ns / 1e6;
+        l.callbacks = _callbacks;
+        l.loopback_ms = _loopback_ms;
+        return l;
+    }
+
+    AudioLatency AudioDevice::self_test(int clicks)
+    {
+        // A result from an earlier configuration must not survive a test
+        // that hears nothing.
+        _loopback_ms = 0.0;
+        if (!acquire())
+            return latency();
+
+        const AudioConfig s = spec();
+        if (!SDL_AUDIO_ISSIGNED(s.format) && !SDL_AUDIO_ISFLOAT(s.format))
+        {
+            std::cout << "Error in AudioDevice::self_test(): Unsigned sample "
+                      << "formats are not supported.\n";
+            release();
+            return latency();
+        }
+
+        // A single non-zero sample followed by a buffer of silence.
+        const int frame = SDL_AUDIO_BITSIZE(s.format) / 8 * s.channels;
+        std::vector<uint8_t> click(frame * s.chunk, 0);
+        for (int i = 0; i < SDL_AUDIO_BITSIZE(s.format) / 8; ++i)
+            click[i] = 0x40;
+        Mix_Chunk* chunk = Mix_QuickLoad_RAW(click.data(), click.size());
+
+        Probe p;
+        p.heard = 0;
+        add_post_mix(probe, &p);
+
+        VoiceParams params;
+        params.priority = 1 << 30;
+        params.coalesce = 0;
+        double total = 0.0;
+        int heard = 0;
+        for (int i = 0; chunk != NULL && i < clicks; ++i)
+        {
+            p.heard = 0;
+            const uint64_t start = now_ns();
+            const int channel = _voices.play(chunk, params);
+            if (channel < 0)
+                break;
+            while (p.heard == 0 && now_ns() - start < 1000000000ull)
+                SDL_Delay(1);
+            if (p.heard != 0)
+            {
+                total += (p.heard - start) / 1e6;
+                ++heard;
+            }
+            while (Mix_Playing(channel))
+                SDL_Delay(1);
+        }
+
+        remove_post_mix(probe, &p);
+        if (chunk != NULL)
+        {
+            _voices.stop(chunk);
+            Mix_FreeChunk(chunk);
+        }
+
+        if (heard == 0)
+            std::cout << "Error in AudioDevice::self_test(): No click was heard.\n";
+        else
+            // From play() to the mixed buffer, then one more buffer until
+            // that buffer is played.
+            _loopback_ms = total / heard + 1000.0 * s.chunk / s.frequency;
+
+        AudioLatency l = latency();
+        release();
+        return l;
+    }
+
+    AudioStats AudioDevice::stats() const
+    {
+        AudioStats s;
+        s.callbacks = _stat_callbacks;
+        s.mix_ms = _mix_ns / 1e6;
+        s.mix_ms_avg = s.callbacks > 0 ? _mix_total_ns / 1e6 / s.callbacks : 0.0;
+        s.mix_ms_max = _mix_max_ns / 1e6;
+        s.period_ms = _last_period_ns / 1e6;
+        s.overruns = _overruns;
+        s.underruns = _underruns;
+        s.voices = _voices_mixed;
+        s.peak = _peak;
+        s.peak_max = _peak_max;
+        return s;
+    }
+
+    void AudioDevice::reset_stats()
+    {
+        // The audio thread clears them, so it never sees half of a reset.
+        _reset = true;
+    }
+
+    void AudioDevice::set_timing(bool timing)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _timing = timing;
+        _voices.set_effect(timing ? _voice_mixed : NULL, this);
+    }
+
+    size_t AudioDevice::history(std::vector<AudioSample>& samples) const
+    {
+        const uint64_t head = _head.load(std::memory_order_acquire);
+        const uint64_t first = std::min(_first.load(std::memory_order_acquire), head);
+        const uint64_t n = std::min<uint64_t>(head - first, AUDIO_HISTORY - 1);
+        samples.resize(n);
+        for (uint64_t i = 0; i < n; ++i)
+            samples[i] = _history[(head - n + i) % AUDIO_HISTORY];
+
+        // Drop what the audio thread overwrote while this was copying.
+        const uint64_t now = _head.load(std::memory_order_acquire);
+        const uint64_t oldest = head - n;
+        if (now + 1 > oldest + AUDIO_HISTORY)
+        {
+            const uint64_t lost = std::min<uint64_t>(n, now + 1 - oldest - AUDIO_HISTORY);
+            samples.erase(samples.begin(), samples.begin() + lost);
+        }
+        return samples.size();
+    }
+
+    //------------------------------------------------------------------------
+    // Private Functions - You cannot call these.
+    //------------------------------------------------------------------------
+
+    float AudioDevice::_measure_peak(const uint8_t* stream, int bytes) const
+    {
+        float peak = 0.0f;
+        if (_spec.format == AUDIO_S16SYS)
+        {
+            const int16_t* s = reinterpret_cast<const int16_t*>(stream);
+            int m = 0;
+            for (int i = 0; i < bytes / 2; ++i)
+                m = std::max(m, std::abs(static_cast<int>(s[i])));
+            peak = m / 32768.0f;
+        }
+        else if (_spec.format == AUDIO_F32SYS)
+        {
+            const float* s = reinterpret_cast<const float*>(stream);
+            for (int i = 0; i < bytes / 4; ++i)
+                peak = std::max(peak, std::fabs(s[i]));
+        }
+        return peak;
+    }
+
+    // Updates the stats at the end of a mixing callback. Only the audio
+    // thread calls this.
+    void AudioDevice::_record(uint64_t now, uint64_t period)
+    {
+        if (_reset.exchange(false))
+        {
+            _stat_callbacks = 0;
+            _mix_total_ns = 0;
+            _mix_max_ns = 0;
+            _overruns = 0;
+            _underruns = 0;
+            _peak_max = 0.0f;
+            // Earlier callbacks, e.g. from the last time the device was
+            // open, are left out of history() from now on.
+            _first.store(_head.load(std::memory_order_relaxed), std::memory_order_release);
+        }
+
+        const int mixed = _mixed.exchange(0);
+        const uint64_t mix = mixed > 0 ? now - _mix_start_ns : 0;
+        const uint64_t buffer = 1000000000ull * _spec.chunk / _spec.frequency;
+        const bool overrun = mix > buffer;
+        const bool underrun = period > buffer + buffer / 2;
+
+        ++_stat_callbacks;
+        _mix_ns = mix;
+        _mix_total_ns += mix;
+        if (mix > _mix_max_ns)
+            _mix_max_ns = mix;
+        _last_period_ns = period;
+        _overruns += overrun;
+        _underruns += underrun;
+        _voices_mixed = mixed;
+
+        const uint64_t head = _head.load(std::memory_order_relaxed);
+        AudioSample& s = _history[head % AUDIO_HISTORY];
+        s.time_ns = now;
+        s.mix_ms = mix / 1e6f;
+        s.period_ms = period / 1e6f;
+        s.peak = _peak;
+        s.voices = mixed;
+        s.underrun = underrun;
+        s.overrun = overrun;
+        _head.store(head + 1, std::memory_order_release);
+    }
+
+    // Run by SDL_mixer after each voice it mixes. The first one marks the
+    // start of the callback's mixing.
+    void AudioDevice::_voice_mixed(int channel, void* stream, int bytes, void* device)
+    {
+        AudioDevice* d = static_cast<AudioDevice*>(device);
+        if (d->_mixed.fetch_add(1, std::memory_order_relaxed) == 0)
+            d->_mix_start_ns.store(now_ns(), std::memory_order_relaxed);
+    }
+
+    // The one SDL_mixer post-mix hook. Runs in the audio thread.
+    void AudioDevice::_post_mix(void* device, uint8_t* stream, int bytes)
+    {
+        AudioDevice* d = static_cast<AudioDevice*>(device);
+
+        const uint64_t now = now_ns();
+        const uint64_t last = d->_last_ns.exchange(now);
+        const uint64_t period = last != 0 ? now - last : 0;
+        if (last != 0)
+        {
+            // Moving averages over about 16 callbacks.
+            const int64_t p = period;
+            int64_t mean = d->_period_ns;
+            mean = mean == 0 ? p : mean + (p - mean) / 16;
+            const int64_t off = p > mean ? p - mean : mean - p;
+            const int64_t jitter = d->_jitter_ns;
+            d->_period_ns = mean;
+            d->_jitter_ns = jitter + (off - jitter) / 16;
+        }
+        ++d->_callbacks;
+
+        d->_native.mix(stream, bytes);
+
+        // SDL holds the device lock around the callback, which is what
+        // add_post_mix() and remove_post_mix() take.
+        for (int i = 0; i < d->_tap_count; ++i)
+            d->_taps[i].first(d->_taps[i].second, stream, bytes);
+
+        // What the device will play, after every post-mix function.
+        const float peak = d->_measure_peak(stream, bytes);
+        d->_peak = peak;
+        if (peak > d->_peak_max)
+            d->_peak_max = peak;
+        d->_record(now_ns(), period);
+    }
+}
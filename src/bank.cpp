@@ -0,0 +1,230 @@
+/*
+ * SDLX, a SDL graphics library for CS students.
+ * Copyright (C) 2017, Seth Kasmann, Yihsiang Liow
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <fstream>
+#include <iostream>
+#include "bank.h"
+#include "context.h"
+#include "files.h"
+#include "sdllib.h"
+#include "profile.h"
+
+namespace sdlx {
+
+    struct SoundHandle::Sample
+    {
+        std::string filename;
+        PcmBuffer pcm;
+        std::atomic<Mix_Chunk*> chunk;
+    };
+
+    //------------------------------------------------------------------------
+    // SoundHandle Class
+    //------------------------------------------------------------------------
+
+    SoundHandle::SoundHandle()
+    : _sample(nullptr)
+    {}
+
+    bool SoundHandle::ready() const
+    {
+        return _sample != nullptr && _sample->chunk.load() != nullptr;
+    }
+
+    int SoundHandle::play()
+    {
+        if (_sample == nullptr)
+            return -1;
+        return context().audio().play(_sample->chunk.load(), _params);
+    }
+
+    int SoundHandle::play_at(float x, float y)
+    {
+        Mix_Chunk* chunk = _sample != nullptr ? _sample->chunk.load() : nullptr;
+        if (chunk == nullptr)
+            return -1;
+        return context().audio().spatial().play(chunk, _params, x, y);
+    }
+
+    void SoundHandle::set_priority(int priority)
+    {
+        _params.priority = priority;
+    }
+
+    void SoundHandle::set_limit(int limit)
+    {
+        _params.limit = limit;
+    }
+
+    void SoundHandle::set_coalesce(uint32_t ms)
+    {
+        _params.coalesce = ms;
+    }
+
+    void SoundHandle::set_volume(int volume)
+    {
+        _params.volume = volume;
+    }
+
+    //------------------------------------------------------------------------
+    // SoundBank Class
+    //------------------------------------------------------------------------
+
+    SoundBank::SoundBank(int threads)
+    : _pending(0), _audio(context().audio().acquire()), _pool(threads)
+    {}
+
+    SoundBank::~SoundBank()
+    {
+        // Let the decoders finish before freeing what they made.
+        _pool.wait();
+        for (auto& s : _samples)
+        {
+            Mix_Chunk* chunk = s.second->chunk.load();
+            if (chunk != nullptr)
+            {
+                context().audio().stop(chunk);
+                Mix_FreeChunk(chunk);
+            }
+        }
+        if (_audio)
+            context().audio().release();
+    }
+
+    int SoundBank::load(const std::string& path)
+    {
+        if (!is_directory(path))
+            return _add(path) ? 1 : 0;
+
+        std::vector<std::string> files = list_files(path);
+        int added = 0;
+        for (size_t i = 0; i < files.size(); ++i)
+            added += _add(files[i]);
+        return added;
+    }
+
+    int SoundBank::load_manifest(const std::string& filename)
+    {
+        std::ifstream in(filename.c_str());
+        if (!in)
+        {
+            std::cout << "Error in SoundBank::load_manifest(): Cannot read "
+                      << filename << '\n';
+            return 0;
+        }
+
+        int added = 0;
+        std::string line;
+        while (std::getline(in, line))
+        {
+            const size_t begin = line.find_first_not_of(" \t\r");
+            if (begin == std::string::npos || line[begin] == '#')
+                continue;
+            const size_t end = line.find_last_not_of(" \t\r");
+            added += load(line.substr(begin, end - begin + 1));
+        }
+        return added;
+    }
+
+    void SoundBank::wait()
+    {
+        _pool.wait();
+    }
+
+    int SoundBank::pending() const
+    {
+        return _pending;
+    }
+
+    SoundHandle SoundBank::get(const std::string& name) const
+    {
+        SoundHandle handle;
+        std::unordered_map<std::string, Sample*>::const_iterator p = _names.find(name);
+        if (p == _names.end())
+        {
+            p = _names.find(canonical_path(name));
+            if (p == _names.end())
+            {
+                std::cout << "Error in SoundBank::get(): No sample " << name << '\n';
+                return handle;
+            }
+        }
+        handle._sample = p->second;
+        return handle;
+    }
+
+    size_t SoundBank::size() const
+    {
+        return _samples.size();
+    }
+
+    size_t SoundBank::bytes() const
+    {
+        size_t total = 0;
+        for (auto& s : _samples)
+        {
+            Mix_Chunk* chunk = s.second->chunk.load();
+            if (chunk != nullptr)
+                total += chunk->alen;
+        }
+        return total;
+    }
+
+    //------------------------------------------------------------------------
+    // Private Functions - You cannot call these.
+    //------------------------------------------------------------------------
+
+    // Returns true if the file was not in the bank yet.
+    bool SoundBank::_add(const std::string& filename)
+    {
+        const std::string key = canonical_path(filename);
+        std::unique_ptr<Sample>& slot = _samples[key];
+        if (slot)
+        {
+            _names[filename] = slot.get();
+            return false;
+        }
+
+        slot.reset(new Sample);
+        Sample* sample = slot.get();
+        sample->filename = filename;
+        sample->chunk = nullptr;
+        _names[filename] = sample;
+        _names[key] = sample;
+
+        if (!_audio)
+            return true;
+
+        ++_pending;
+        _pool.submit([this, sample] {
+            SDLX_ZONE("SoundBank::decode");
+            AudioDevice& audio = context().audio();
+            sample->pcm = audio.pcm().get(sample->filename, audio.spec());
+            Mix_Chunk* chunk = nullptr;
+            if (sample->pcm)
+                chunk = Mix_QuickLoad_RAW(const_cast<Uint8*>(sample->pcm->data()),
+                                          static_cast<Uint32>(sample->pcm->size()));
+            if (chunk == nullptr)
+                std::cout << "Error in SoundBank: " << sample->filename << ": "
+                          << Mix_GetError() << '\n';
+            sample->chunk = chunk;
+            --_pending;
+        });
+        return true;
+    }
+}
@@ -0,0 +1,111 @@
+/*
+ * SDLX, a SDL graphics library for CS students.
+ * Copyright (C) 2017, Seth Kasmann, Yihsiang Liow
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <iostream>
+#include "cache.h"
+#include "files.h"
+#include "context.h"
+#include "window.h"
+#include "sdllib.h"
+#include "profile.h"
+
+namespace sdlx {
+
+    ImageCache::ImageCache(Window& window)
+    : _window(window)
+    {
+        context().require(INIT_IMAGE);
+    }
+
+    std::shared_ptr<Image> ImageCache::get(const std::string& filename)
+    {
+        const std::string key = canonical_path(filename);
+
+        std::shared_ptr<Image> image = _images[key].lock();
+        if (image)
+            return image;
+
+        SDLX_ZONE("ImageCache::load");
+
+        SDL_Surface* surface = IMG_Load(filename.c_str());
+        if (surface == NULL)
+        {
+            std::cout << "Error in ImageCache::get(): Cannot load " << filename
+                      << ": " << IMG_GetError() << '\n';
+            _images.erase(key);
+            return image;
+        }
+
+        image.reset(new Image(surface, _window));
+        SDL_FreeSurface(surface);
+
+        if (image->get_texture() == NULL)
+        {
+            std::cout << "Error in ImageCache::get(): " << SDL_GetError() << '\n';
+            _images.erase(key);
+            return std::shared_ptr<Image>();
+        }
+
+        _images[key] = image;
+        return image;
+    }
+
+    int ImageCache::refcount(const std::string& filename) const
+    {
+        std::map<std::string, std::weak_ptr<Image> >::const_iterator p
+            = _images.find(canonical_path(filename));
+        return p == _images.end() ? 0 : p->second.use_count();
+    }
+
+    size_t ImageCache::size() const
+    {
+        size_t n = 0;
+        std::map<std::string, std::weak_ptr<Image> >::const_iterator p;
+        for (p = _images.begin(); p != _images.end(); ++p)
+        {
+            if (!p->second.expired())
+                ++n;
+        }
+        return n;
+    }
+
+    size_t ImageCache::resident_bytes() const
+    {
+        size_t bytes = 0;
+        std::map<std::string, std::weak_ptr<Image> >::const_iterator p;
+        for (p = _images.begin(); p != _images.end(); ++p)
+        {
+            std::shared_ptr<Image> image = p->second.lock();
+            if (image)
+                bytes += image->get_bytes();
+        }
+        return bytes;
+    }
+
+    void ImageCache::purge()
+    {
+        std::map<std::string, std::weak_ptr<Image> >::iterator p = _images.begin();
+        while (p != _images.end())
+        {
+            if (p->second.expired())
+                _images.erase(p++);
+            else
+                ++p;
+        }
+    }
+}
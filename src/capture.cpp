@@ -0,0 +1,198 @@
+/*
+ * SDLX, a SDL graphics library for CS students.
+ * Copyright (C) 2017, Seth Kasmann, Yihsiang Liow
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include "capture.h"
+#include "sdllib.h"
+#include "profile.h"
+
+namespace sdlx {
+
+    namespace {
+
+        bool ends_with(const std::string& s, const char* suffix)
+        {
+            std::string t(suffix);
+            return s.size() >= t.size()
+                && s.compare(s.size() - t.size(), t.size(), t) == 0;
+        }
+    }
+
+    Capture::Capture()
+    : _quit(false), _next(0), _dropped(0), _written(0)
+    {
+        _worker = std::thread(&Capture::_run, this);
+    }
+
+    Capture::~Capture()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _quit = true;
+        }
+        _ready.notify_one();
+        _worker.join();
+    }
+
+    void Capture::request(const std::string& filename)
+    {
+        if (filename.empty())
+        {
+            char name[32];
+            std::snprintf(name, sizeof(name), "capture_%05u.png", _next++);
+            _requests.push_back(name);
+        }
+        else
+        {
+            _requests.push_back(filename);
+        }
+    }
+
+    void Capture::service(SDL_Renderer* renderer)
+    {
+        SDLX_ZONE("Capture::service");
+
+        for (size_t i = 0; i < _requests.size(); ++i)
+        {
+            int index = -1;
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                for (int j = 0; j < CAPTURE_BUFFERS && index < 0; ++j)
+                {
+                    if (!_slots[j].busy)
+                        index = j;
+                }
+                if (index >= 0)
+                    _slots[index].busy = true;
+            }
+
+            if (index < 0)
+            {
+                ++_dropped;
+                continue;
+            }
+
+            // The slot is ours until it is queued; the buffer only grows
+            // when the window does.
+            Slot& slot = _slots[index];
+            SDL_GetRendererOutputSize(renderer, &slot.w, &slot.h);
+            slot.pixels.resize(static_cast<size_t>(slot.w) * slot.h * 4);
+            slot.filename = _requests[i];
+
+            if (SDL_RenderReadPixels(renderer, NULL, SDL_PIXELFORMAT_ARGB8888,
+                                     slot.pixels.data(), slot.w * 4) != 0)
+            {
+                std::cout << "Error in Capture: " << SDL_GetError() << '\n';
+                std::lock_guard<std::mutex> lock(_mutex);
+                slot.busy = false;
+                continue;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _queue.push_back(index);
+            }
+            _ready.notify_one();
+        }
+        _requests.clear();
+    }
+
+    void Capture::flush()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        for (;;)
+        {
+            bool busy = false;
+            for (int i = 0; i < CAPTURE_BUFFERS; ++i)
+                busy = busy || _slots[i].busy;
+            if (!busy)
+                break;
+            _done.wait(lock);
+        }
+    }
+
+    uint32_t Capture::dropped() const
+    {
+        return _dropped;
+    }
+
+    uint32_t Capture::written() const
+    {
+        return _written;
+    }
+
+    //------------------------------------------------------------------------
+    // Private Functions - You cannot call these.
+    //------------------------------------------------------------------------
+
+    void Capture::_run()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        for (;;)
+        {
+            while (_queue.empty() && !_quit)
+                _ready.wait(lock);
+            if (_queue.empty())
+                break;
+
+            int index = _queue.front();
+            _queue.pop_front();
+
+            lock.unlock();
+            _write(_slots[index]);
+            lock.lock();
+
+            _slots[index].busy = false;
+            ++_written;
+            _done.notify_all();
+        }
+    }
+
+    void Capture::_write(Slot& slot)
+    {
+        SDLX_ZONE("Capture::write");
+
+        if (ends_with(slot.filename, ".png") || ends_with(slot.filename, ".bmp"))
+        {
+            SDL_Surface* s = SDL_CreateRGBSurfaceWithFormatFrom(slot.pixels.data(),
+                slot.w, slot.h, 32, slot.w * 4, SDL_PIXELFORMAT_ARGB8888);
+            int status = -1;
+            if (s != NULL)
+            {
+                if (ends_with(slot.filename, ".png"))
+                    status = IMG_SavePNG(s, slot.filename.c_str());
+                else
+                    status = SDL_SaveBMP(s, slot.filename.c_str());
+                SDL_FreeSurface(s);
+            }
+            if (status != 0)
+                std::cout << "Error in Capture: Cannot write " << slot.filename
+                          << ": " << SDL_GetError() << '\n';
+        }
+        else
+        {
+            std::ofstream out(slot.filename.c_str(), std::ios::binary);
+            out.write(reinterpret_cast<const char*>(slot.pixels.data()),
+                      slot.pixels.size());
+            if (!out)
+                std::cout << "Error in Capture: Cannot write " << slot.filename << '\n';
+        }
+    }
+}
@@ -0,0 +1,204 @@
+/*
+ * SDLX, a SDL graphics library for CS students.
+ * Copyright (C) 2017, Seth Kasmann, Yihsiang Liow
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include "context.h"
+#include "sdllib.h"
+
+namespace sdlx {
+
+    namespace {
+
+        const char* const NAMES[SUBSYSTEMS] = {
+            "timer", "audio", "video", "joystick", "haptic",
+            "gamecontroller", "events", "image", "ttf", "mixer"
+        };
+
+        const Uint32 SDL_FLAGS[SUBSYSTEMS] = {
+            SDL_INIT_TIMER, SDL_INIT_AUDIO, SDL_INIT_VIDEO, SDL_INIT_JOYSTICK,
+            SDL_INIT_HAPTIC, SDL_INIT_GAMECONTROLLER, SDL_INIT_EVENTS, 0, 0, 0
+        };
+
+        const int IMG_FLAGS = IMG_INIT_JPG | IMG_INIT_PNG | IMG_INIT_TIF;
+        const int MIX_FLAGS = MIX_INIT_FLAC | MIX_INIT_OGG;
+
+        int index(Subsystem subsystem)
+        {
+            for (int i = 0; i < SUBSYSTEMS; ++i)
+                if (subsystem == (1u << i))
+                    return i;
+            return -1;
+        }
+    }
+
+    Context& context()
+    {
+        static Context c;
+        return c;
+    }
+
+    Context::Context()
+    : _ready(0), _failed(0)
+    {
+        for (int i = 0; i < SUBSYSTEMS; ++i)
+            _ms[i] = 0.0;
+    }
+
+    Context::~Context()
+    {
+        _audio.close();
+
+        // A failed image or mixer start may still have loaded some formats,
+        // so those are shut down as well.
+        const uint32_t started = _ready | _failed;
+        for (int i = SUBSYSTEMS - 1; i >= 0; --i)
+            if (started & (1u << i))
+                _stop(i);
+        SDL_Quit();
+    }
+
+    bool Context::require(uint32_t subsystems)
+    {
+        if (subsystems & INIT_MIXER)
+            subsystems |= INIT_AUDIO;
+        if (subsystems & INIT_GAMECONTROLLER)
+            subsystems |= INIT_JOYSTICK;
+
+        // Nearly every call finds everything already started.
+        if ((_ready.load(std::memory_order_acquire) & subsystems) == subsystems)
+            return true;
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        bool ok = true;
+        for (int i = 0; i < SUBSYSTEMS; ++i)
+        {
+            const uint32_t bit = 1u << i;
+            if (!(subsystems & bit) || (_ready.load() & bit))
+                continue;
+
+            // A subsystem that failed is not retried, so the error is only
+            // printed once.
+            if (_failed & bit)
+                ok = false;
+            else if (_start(i))
+                _ready.fetch_or(bit, std::memory_order_release);
+            else
+            {
+                _failed |= bit;
+                ok = false;
+            }
+        }
+        return ok;
+    }
+
+    bool Context::ready(uint32_t subsystems) const
+    {
+        return (_ready.load(std::memory_order_acquire) & subsystems) == subsystems;
+    }
+
+    double Context::startup_ms(Subsystem subsystem) const
+    {
+        int i = index(subsystem);
+        return i < 0 ? 0.0 : _ms[i];
+    }
+
+    void Context::print_startup(std::ostream& out) const
+    {
+        double total = 0.0;
+        char line[64];
+        for (int i = 0; i < SUBSYSTEMS; ++i)
+        {
+            if (!(_ready.load() & (1u << i)))
+                continue;
+            std::snprintf(line, sizeof(line), "%-16s %8.2f ms\n", NAMES[i], _ms[i]);
+            out << line;
+            total += _ms[i];
+        }
+        std::snprintf(line, sizeof(line), "%-16s %8.2f ms\n", "total", total);
+        out << line;
+    }
+
+    AudioDevice& Context::audio()
+    {
+        return _audio;
+    }
+
+    //------------------------------------------------------------------------
+    // Private Functions - You cannot call these.
+    //------------------------------------------------------------------------
+
+    bool Context::_start(int i)
+    {
+        using namespace std::chrono;
+        const steady_clock::time_point begin = steady_clock::now();
+
+        bool ok = true;
+        switch (1u << i)
+        {
+        case INIT_IMAGE:
+            ok = (IMG_Init(IMG_FLAGS) & IMG_FLAGS) == IMG_FLAGS;
+            if (!ok)
+                std::cout << "Failed to initialize JPG, PNG, & TIF support."
+                          << std::endl << "IMG_Init: " << IMG_GetError()
+                          << std::endl;
+            break;
+        case INIT_TTF:
+            ok = TTF_Init() != -1;
+            if (!ok)
+                std::cout << "TTF_Init: " << TTF_GetError() << std::endl;
+            break;
+        case INIT_MIXER:
+            ok = (Mix_Init(MIX_FLAGS) & MIX_FLAGS) == MIX_FLAGS;
+            if (!ok)
+                std::cout << "Failed to initialize FLAC & OGG support."
+                          << std::endl << "MIX_Init: " << Mix_GetError()
+                          << std::endl;
+            break;
+        default:
+            ok = SDL_InitSubSystem(SDL_FLAGS[i]) == 0;
+            if (!ok)
+                std::cout << "SDL_InitSubSystem(" << NAMES[i] << "): "
+                          << SDL_GetError() << std::endl;
+            break;
+        }
+
+        _ms[i] = duration_cast<nanoseconds>(steady_clock::now() - begin).count() / 1e6;
+        return ok;
+    }
+
+    void Context::_stop(int i)
+    {
+        switch (1u << i)
+        {
+        case INIT_IMAGE:
+            IMG_Quit();
+            break;
+        case INIT_TTF:
+            TTF_Quit();
+            break;
+        case INIT_MIXER:
+            while (Mix_Init(0))
+                Mix_Quit();
+            break;
+        default:
+            SDL_QuitSubSystem(SDL_FLAGS[i]);
+            break;
+        }
+    }
+}
@@ -18,6 +18,7 @@
 
 #include <iostream>
 #include "device.h"
+#include "context.h"
 #include "sdllib.h"
 
 namespace sdlx {
@@ -103,6 +104,7 @@ namespace sdlx {
     Joystick::Joystick()
     : _joy(nullptr)
     {
+        context().require(INIT_JOYSTICK);
         if (SDL_NumJoysticks() > 0)
         {
             SDL_JoystickEventState(SDL_ENABLE);
@@ -115,9 +117,28 @@ namespace sdlx {
         }
     }
 
+    Joystick::Joystick(Joystick&& other)
+    : _joy(other._joy)
+    {
+        other._joy = nullptr;
+    }
+
+    Joystick& Joystick::operator=(Joystick&& other)
+    {
+        if (this != &other)
+        {
+            if (_joy != nullptr)
+                SDL_JoystickClose(_joy);
+            _joy = other._joy;
+            other._joy = nullptr;
+        }
+        return *this;
+    }
+
     Joystick::~Joystick()
     {
-        SDL_JoystickClose(_joy);
+        if (_joy != nullptr)
+            SDL_JoystickClose(_joy);
     }
 
     int Joystick::num_balls() const
@@ -0,0 +1,476 @@
+/*
+ * SDLX, a SDL graphics library for CS students.
+ * Copyright (C) 2017, Seth Kasmann, Yihsiang Liow
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include "audio.h"
+#include "effects.h"
+#include "sdllib.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SDLX_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace sdlx {
+
+    namespace {
+
+        const float PI = 3.14159265f;
+
+        // Freeverb's tunings at 44100 Hz, in samples. The right channel's
+        // combs are a little longer so the two sides differ.
+        const int COMB_LENGTHS[4] = { 1116, 1188, 1277, 1356 };
+        const int ALLPASS_LENGTHS[2] = { 556, 441 };
+        const int STEREO_SPREAD = 23;
+        const float REVERB_INPUT = 0.03f;
+
+        float from_db(float db)
+        {
+            return std::pow(10.0f, db / 20.0f);
+        }
+
+        // Envelope coefficient for a time constant.
+        float coefficient(float ms, int frequency)
+        {
+            if (ms <= 0.0f)
+                return 0.0f;
+            return std::exp(-1.0f / (ms * 0.001f * frequency));
+        }
+    }
+
+    EffectSettings::EffectSettings()
+    : filter(FILTER_OFF), cutoff(1000.0f), q(0.707f), compressor(false),
+      threshold_db(-18.0f), ratio(4.0f), attack_ms(10.0f), release_ms(100.0f),
+      makeup_db(0.0f), limiter(false), ceiling_db(-1.0f), reverb(0.0f),
+      room(0.5f), damping(0.5f)
+    {}
+
+    EffectChain::EffectChain()
+    : _changed(false), _busy(false), _device(NULL), _format(0),
+      _channels(0), _frequency(44100), _compress_env(0.0f), _limit_env(0.0f),
+      _reduction(0.0f)
+    {
+        _pending = _compute(EffectSettings());
+        _params = _pending;
+        _float.resize(EFFECT_BLOCK * 2);
+        _gain.resize(EFFECT_BLOCK);
+        _wet.resize(EFFECT_BLOCK * 2);
+        _reset();
+    }
+
+    EffectChain::~EffectChain()
+    {
+        detach();
+    }
+
+    void EffectChain::set(const EffectSettings& settings)
+    {
+        while (_busy.exchange(true, std::memory_order_acquire))
+        {}
+        _pending = _compute(settings);
+        _changed.store(true, std::memory_order_relaxed);
+        _busy.store(false, std::memory_order_release);
+    }
+
+    EffectSettings EffectChain::settings() const
+    {
+        while (_busy.exchange(true, std::memory_order_acquire))
+        {}
+        const EffectSettings s = _pending.s;
+        _busy.store(false, std::memory_order_release);
+        return s;
+    }
+
+    float EffectChain::reduction_db() const
+    {
+        return _reduction.load(std::memory_order_relaxed);
+    }
+
+    // Called by the AudioDevice when it opens, with the format it got.
+    void EffectChain::attach(AudioDevice& device, const AudioConfig& spec)
+    {
+        detach();
+        if ((spec.format != AUDIO_S16SYS && spec.format != AUDIO_F32SYS)
+            || spec.channels < 1 || spec.channels > 2)
+        {
+            std::cout << "Error in EffectChain: Only 16-bit or float, mono or "
+                      << "stereo audio is supported.\n";
+            return;
+        }
+
+        _format = spec.format;
+        _channels = spec.channels;
+        _frequency = spec.frequency;
+        const float scale = spec.frequency / 44100.0f;
+        for (int c = 0; c < 2; ++c)
+        {
+            for (int k = 0; k < COMBS; ++k)
+            {
+                const int n = static_cast<int>((COMB_LENGTHS[k] + c * STEREO_SPREAD) * scale);
+                _combs[c][k].buffer.assign(std::max(n, 1), 0.0f);
+            }
+            for (int k = 0; k < ALLPASSES; ++k)
+            {
+                const int n = static_cast<int>((ALLPASS_LENGTHS[k] + c * STEREO_SPREAD) * scale);
+                _allpasses[c][k].buffer.assign(std::max(n, 1), 0.0f);
+            }
+        }
+        _reset();
+
+        // Coefficients depend on the frequency.
+        set(settings());
+        _params = _pending;
+        _changed = false;
+
+        // Native voices are added to SDL_mixer's buffer before the post-mix
+        // functions run, so this sees everything that is played.
+        _device = &device;
+        device.add_post_mix(_run, this);
+    }
+
+    void EffectChain::detach()
+    {
+        if (_device == NULL)
+            return;
+        _device->remove_post_mix(_run, this);
+        _device = NULL;
+    }
+
+    //------------------------------------------------------------------------
+    // Private Functions - You cannot call these.
+    //------------------------------------------------------------------------
+
+    EffectChain::Params EffectChain::_compute(const EffectSettings& s) const
+    {
+        Params p;
+        p.s = s;
+
+        // Biquad coefficients from the Audio EQ Cookbook.
+        const float cutoff = std::min(std::max(s.cutoff, 10.0f), 0.45f * _frequency);
+        const float w = 2.0f * PI * cutoff / _frequency;
+        const float alpha = std::sin(w) / (2.0f * std::max(s.q, 0.1f));
+        const float cw = std::cos(w);
+        const float a0 = 1.0f + alpha;
+        if (s.filter == FILTER_HIGHPASS)
+        {
+            p.b0 = (1.0f + cw) / 2.0f / a0;
+            p.b1 = -(1.0f + cw) / a0;
+        }
+        else
+        {
+            p.b0 = (1.0f - cw) / 2.0f / a0;
+            p.b1 = (1.0f - cw) / a0;
+        }
+        p.b2 = p.b0;
+        p.a1 = -2.0f * cw / a0;
+        p.a2 = (1.0f - alpha) / a0;
+
+        p.threshold = from_db(s.threshold_db);
+        p.slope = 1.0f - 1.0f / std::max(s.ratio, 1.0f);
+        p.attack = coefficient(s.attack_ms, _frequency);
+        p.release = coefficient(s.release_ms, _frequency);
+        p.makeup = from_db(s.makeup_db);
+
+        p.ceiling = from_db(std::min(s.ceiling_db, 0.0f));
+        p.limit_attack = coefficient(0.5f, _frequency);
+        p.limit_release = coefficient(50.0f, _frequency);
+
+        const float room = std::min(std::max(s.room, 0.0f), 1.0f);
+        const float damping = std::min(std::max(s.damping, 0.0f), 1.0f);
+        p.feedback = 0.7f + 0.28f * room;
+        p.damp = 0.4f * damping;
+        return p;
+    }
+
+    void EffectChain::_reset()
+    {
+        for (int c = 0; c < 2; ++c)
+        {
+            _z1[c] = _z2[c] = 0.0f;
+            for (int k = 0; k < COMBS; ++k)
+            {
+                std::fill(_combs[c][k].buffer.begin(), _combs[c][k].buffer.end(), 0.0f);
+                _combs[c][k].position = 0;
+                _comb_store[c][k] = 0.0f;
+            }
+            for (int k = 0; k < ALLPASSES; ++k)
+            {
+                std::fill(_allpasses[c][k].buffer.begin(), _allpasses[c][k].buffer.end(), 0.0f);
+                _allpasses[c][k].position = 0;
+            }
+        }
+        _compress_env = 0.0f;
+        _limit_env = 0.0f;
+        _reduction = 0.0f;
+    }
+
+    void EffectChain::_process(float* samples, int frames)
+    {
+        const Params& p = _params;
+        float gain = 1.0f;
+        if (p.s.filter != FILTER_OFF)
+            _filter(samples, frames);
+        if (p.s.compressor)
+            gain = _dynamics(samples, frames, _compress_env, p.threshold, p.slope,
+                             p.attack, p.release, p.makeup);
+        if (p.s.reverb > 0.0f)
+            _reverb(samples, frames);
+        if (p.s.limiter)
+        {
+            gain *= _dynamics(samples, frames, _limit_env, p.ceiling, 1.0f,
+                              p.limit_attack, p.limit_release, 1.0f);
+            // Whatever the envelope was too slow for.
+            const int n = frames * _channels;
+            int i = 0;
+#ifdef SDLX_SSE2
+            const __m128 hi = _mm_set1_ps(p.ceiling);
+            const __m128 lo = _mm_set1_ps(-p.ceiling);
+            for (; i + 4 <= n; i += 4)
+                _mm_storeu_ps(samples + i, _mm_min_ps(hi, _mm_max_ps(lo, _mm_loadu_ps(samples + i))));
+#endif
+            for (; i < n; ++i)
+                samples[i] = std::min(p.ceiling, std::max(-p.ceiling, samples[i]));
+        }
+        _reduction.store(20.0f * std::log10(std::max(gain, 1e-6f)),
+                         std::memory_order_relaxed);
+    }
+
+    // Transposed direct form II. With SSE2 both channels run side by side
+    // in one register.
+    void EffectChain::_filter(float* samples, int frames)
+    {
+        const Params& p = _params;
+#ifdef SDLX_SSE2
+        const __m128 b0 = _mm_set1_ps(p.b0);
+        const __m128 b1 = _mm_set1_ps(p.b1);
+        const __m128 b2 = _mm_set1_ps(p.b2);
+        const __m128 a1 = _mm_set1_ps(p.a1);
+        const __m128 a2 = _mm_set1_ps(p.a2);
+        __m128 z1 = _mm_set_ps(0.0f, 0.0f, _z1[1], _z1[0]);
+        __m128 z2 = _mm_set_ps(0.0f, 0.0f, _z2[1], _z2[0]);
+        for (int i = 0; i < frames; ++i)
+        {
+            float* s = samples + i * _channels;
+            const __m128 x = _channels == 2
+                ? _mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double*>(s)))
+                : _mm_load_ss(s);
+            const __m128 y = _mm_add_ps(_mm_mul_ps(b0, x), z1);
+            z1 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(b1, x), _mm_mul_ps(a1, y)), z2);
+            z2 = _mm_sub_ps(_mm_mul_ps(b2, x), _mm_mul_ps(a2, y));
+            if (_channels == 2)
+                _mm_store_sd(reinterpret_cast<double*>(s), _mm_castps_pd(y));
+            else
+                _mm_store_ss(s, y);
+        }
+        float t[4];
+        _mm_storeu_ps(t, z1);
+        _z1[0] = t[0];
+        _z1[1] = t[1];
+        _mm_storeu_ps(t, z2);
+        _z2[0] = t[0];
+        _z2[1] = t[1];
+#else
+        for (int c = 0; c < _channels; ++c)
+        {
+            float z1 = _z1[c], z2 = _z2[c];
+            for (int i = 0; i < frames; ++i)
+            {
+                float& s = samples[i * _channels + c];
+                const float x = s;
+                const float y = p.b0 * x + z1;
+                z1 = p.b1 * x - p.a1 * y + z2;
+                z2 = p.b2 * x - p.a2 * y;
+                s = y;
+            }
+            _z1[c] = z1;
+            _z2[c] = z2;
+        }
+#endif
+    }
+
+    // A peak compressor with both channels linked. Returns the smallest
+    // gain it applied.
+    float EffectChain::_dynamics(float* samples, int frames, float& env,
+                                 float threshold, float slope, float attack,
+                                 float release, float makeup)
+    {
+        float least = 1.0f;
+        for (int i = 0; i < frames; ++i)
+        {
+            float level = std::fabs(samples[i * _channels]);
+            if (_channels == 2)
+                level = std::max(level, std::fabs(samples[i * 2 + 1]));
+            const float k = level > env ? attack : release;
+            env = k * env + (1.0f - k) * level;
+            float g = 1.0f;
+            if (env > threshold)
+                g = std::pow(env / threshold, -slope);
+            least = std::min(least, g);
+            _gain[i] = g * makeup;
+        }
+
+        int i = 0;
+        if (_channels == 2)
+        {
+#ifdef SDLX_SSE2
+            for (; i + 4 <= frames; i += 4)
+            {
+                const __m128 g = _mm_loadu_ps(&_gain[i]);
+                float* s = samples + 2 * i;
+                _mm_storeu_ps(s, _mm_mul_ps(_mm_loadu_ps(s), _mm_unpacklo_ps(g, g)));
+                _mm_storeu_ps(s + 4, _mm_mul_ps(_mm_loadu_ps(s + 4), _mm_unpackhi_ps(g, g)));
+            }
+#endif
+            for (; i < frames; ++i)
+            {
+                samples[2 * i] *= _gain[i];
+                samples[2 * i + 1] *= _gain[i];
+            }
+        }
+        else
+        {
+            for (; i < frames; ++i)
+                samples[i] *= _gain[i];
+        }
+        return least;
+    }
+
+    // Freeverb, cut down to four parallel combs and two allpasses per
+    // channel. With SSE2 the four combs of a channel run in one register.
+    void EffectChain::_reverb(float* samples, int frames)
+    {
+        const Params& p = _params;
+        for (int c = 0; c < _channels; ++c)
+        {
+            Delay* combs = _combs[c];
+            Delay* allpasses = _allpasses[c];
+#ifdef SDLX_SSE2
+            __m128 store = _mm_loadu_ps(_comb_store[c]);
+            const __m128 damp = _mm_set1_ps(p.damp);
+            const __m128 undamp = _mm_set1_ps(1.0f - p.damp);
+            const __m128 feedback = _mm_set1_ps(p.feedback);
+#endif
+            for (int i = 0; i < frames; ++i)
+            {
+                float in = samples[i * _channels];
+                if (_channels == 2)
+                    in += samples[i * 2 + 1];
+                in *= REVERB_INPUT;
+
+                float out[COMBS];
+                for (int k = 0; k < COMBS; ++k)
+                    out[k] = combs[k].buffer[combs[k].position];
+#ifdef SDLX_SSE2
+                const __m128 o = _mm_loadu_ps(out);
+                store = _mm_add_ps(_mm_mul_ps(o, undamp), _mm_mul_ps(store, damp));
+                float write[COMBS];
+                _mm_storeu_ps(write, _mm_add_ps(_mm_set1_ps(in), _mm_mul_ps(store, feedback)));
+#else
+                float write[COMBS];
+                for (int k = 0; k < COMBS; ++k)
+                {
+                    _comb_store[c][k] = out[k] * (1.0f - p.damp) + _comb_store[c][k] * p.damp;
+                    write[k] = in + _comb_store[c][k] * p.feedback;
+                }
+#endif
+                float wet = 0.0f;
+                for (int k = 0; k < COMBS; ++k)
+                {
+                    Delay& d = combs[k];
+                    d.buffer[d.position] = write[k];
+                    if (++d.position == static_cast<int>(d.buffer.size()))
+                        d.position = 0;
+                    wet += out[k];
+                }
+
+                for (int k = 0; k < ALLPASSES; ++k)
+                {
+                    Delay& d = allpasses[k];
+                    const float delayed = d.buffer[d.position];
+                    d.buffer[d.position] = wet + delayed * 0.5f;
+                    if (++d.position == static_cast<int>(d.buffer.size()))
+                        d.position = 0;
+                    wet = delayed - wet;
+                }
+                _wet[i * _channels + c] = wet;
+            }
+#ifdef SDLX_SSE2
+            _mm_storeu_ps(_comb_store[c], store);
+#endif
+        }
+
+        const int n = frames * _channels;
+        for (int i = 0; i < n; ++i)
+            samples[i] += _wet[i] * p.s.reverb;
+    }
+
+    // The post-mix function. Runs in the audio thread.
+    void EffectChain::_run(void* chain, uint8_t* stream, int bytes)
+    {
+        EffectChain* e = static_cast<EffectChain*>(chain);
+
+        // Take new settings if set() is not writing them right now.
+        if (e->_changed.load(std::memory_order_relaxed)
+            && !e->_busy.exchange(true, std::memory_order_acquire))
+        {
+            e->_params = e->_pending;
+            e->_changed.store(false, std::memory_order_relaxed);
+            e->_busy.store(false, std::memory_order_release);
+        }
+
+        const EffectSettings& s = e->_params.s;
+        if (s.filter == FILTER_OFF && !s.compressor && !s.limiter && s.reverb <= 0.0f)
+        {
+            e->_reduction.store(0.0f, std::memory_order_relaxed);
+            return;
+        }
+
+        if (e->_format == AUDIO_F32SYS)
+        {
+            float* samples = reinterpret_cast<float*>(stream);
+            int frames = bytes / (sizeof(float) * e->_channels);
+            for (; frames > 0; frames -= EFFECT_BLOCK)
+            {
+                const int n = std::min(frames, EFFECT_BLOCK);
+                e->_process(samples, n);
+                samples += n * e->_channels;
+            }
+            return;
+        }
+
+        int16_t* samples = reinterpret_cast<int16_t*>(stream);
+        int frames = bytes / (sizeof(int16_t) * e->_channels);
+        float* f = e->_float.data();
+        for (; frames > 0; frames -= EFFECT_BLOCK)
+        {
+            const int n = std::min(frames, EFFECT_BLOCK);
+            const int count = n * e->_channels;
+            for (int i = 0; i < count; ++i)
+                f[i] = samples[i] * (1.0f / 32768.0f);
+            e->_process(f, n);
+            for (int i = 0; i < count; ++i)
+            {
+                const float x = std::min(1.0f, std::max(-1.0f, f[i]));
+                samples[i] = static_cast<int16_t>(x * 32767.0f);
+            }
+            samples += count;
+        }
+    }
+}
@@ -17,6 +17,8 @@
  */
 
 #include "event.h"
+#include "context.h"
+#include "profile.h"
 
 namespace sdlx {
 
@@ -24,8 +26,14 @@ namespace sdlx {
     // Event Class
     //------------------------------------------------------------------------
 
+    Event::Event()
+    {
+        context().require(INIT_EVENTS);
+    }
+
     int Event::poll()
     {
+        SDLX_ZONE("Event::poll");
     	return SDL_PollEvent(&event);
     }
 
@@ -0,0 +1,124 @@
+/*
+ * SDLX, a SDL graphics library for CS students.
+ * Copyright (C) 2017, Seth Kasmann, Yihsiang Liow
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include "files.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+namespace sdlx {
+
+    namespace {
+
+        void walk(const std::string& dir, std::vector<std::string>& files)
+        {
+        #ifdef _WIN32
+            WIN32_FIND_DATAA found;
+            HANDLE h = FindFirstFileA((dir + "/*").c_str(), &found);
+            if (h == INVALID_HANDLE_VALUE)
+            {
+                std::cout << "Error in list_files(): Cannot read " << dir << '\n';
+                return;
+            }
+            do
+            {
+                const std::string name = found.cFileName;
+                if (name == "." || name == "..")
+                    continue;
+                if (found.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+                    walk(dir + "/" + name, files);
+                else
+                    files.push_back(dir + "/" + name);
+            } while (FindNextFileA(h, &found));
+            FindClose(h);
+        #else
+            DIR* d = opendir(dir.c_str());
+            if (d == NULL)
+            {
+                std::cout << "Error in list_files(): Cannot read " << dir << '\n';
+                return;
+            }
+            while (dirent* e = readdir(d))
+            {
+                const std::string name = e->d_name;
+                if (name == "." || name == "..")
+                    continue;
+                const std::string path = dir + "/" + name;
+                struct stat st;
+                if (stat(path.c_str(), &st) != 0)
+                    continue;
+                if (S_ISDIR(st.st_mode))
+                    walk(path, files);
+                else if (S_ISREG(st.st_mode))
+                    files.push_back(path);
+            }
+            closedir(d);
+        #endif
+        }
+    }
+
+    std::string canonical_path(const std::string& path)
+    {
+    #ifdef _WIN32
+        char buffer[_MAX_PATH];
+        if (_fullpath(buffer, path.c_str(), _MAX_PATH) != NULL)
+            return buffer;
+    #else
+        char* resolved = realpath(path.c_str(), NULL);
+        if (resolved != NULL)
+        {
+            std::string s(resolved);
+            free(resolved);
+            return s;
+        }
+    #endif
+        return path;
+    }
+
+    std::vector<std::string> list_files(const std::string& dir)
+    {
+        std::string root = dir;
+        while (root.size() > 1 && (root[root.size() - 1] == '/'
+                                   || root[root.size() - 1] == '\\'))
+            root.erase(root.size() - 1);
+
+        std::vector<std::string> files;
+        walk(root, files);
+        std::sort(files.begin(), files.end());
+        return files;
+    }
+
+    bool is_directory(const std::string& path)
+    {
+    #ifdef _WIN32
+        DWORD attributes = GetFileAttributesA(path.c_str());
+        return attributes != INVALID_FILE_ATTRIBUTES
+            && (attributes & FILE_ATTRIBUTE_DIRECTORY);
+    #else
+        struct stat st;
+        return stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+    #endif
+    }
+}
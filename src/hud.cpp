@@ -0,0 +1,228 @@
+/*
+ * SDLX, a SDL graphics library for CS students.
+ * Copyright (C) 2017, Seth Kasmann, Yihsiang Liow
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include "hud.h"
+#include "image.h"
+#include "sdllib.h"
+
+namespace sdlx {
+
+    namespace {
+
+        // Layout of the overlay, in pixels.
+        const int SCALE   = 2;                      // size of a font pixel
+        const int PAD     = 4;
+        const int LINE    = 7 * SCALE;
+        const int LINES   = 4;
+        const int X       = 4;
+        const int Y       = 4;
+        const int GRAPH_W = 2 * HUD_FRAMES;
+        const int GRAPH_H = 60;
+        const int PANEL_W = GRAPH_W + 2 * PAD;
+        const int PANEL_H = LINES * LINE + GRAPH_H + 3 * PAD;
+        const int GRAPH_X = X + PAD;
+        const int GRAPH_Y = Y + 2 * PAD + LINES * LINE;
+
+        // The graph is scaled so that GRAPH_MS fills its full height.
+        const float GRAPH_MS  = 50.0f;
+        const float TARGET_MS = 1000.0f / 60.0f;
+
+        // A 3x5 pixel font. Bit 14 is the top-left pixel and bit 0 is the
+        // bottom-right pixel of a glyph.
+        uint16_t glyph(char c)
+        {
+            switch (std::toupper(static_cast<unsigned char>(c)))
+            {
+            case '0': return 0x7b6f;
+            case '1': return 0x2c97;
+            case '2': return 0x73e7;
+            case '3': return 0x73cf;
+            case '4': return 0x5bc9;
+            case '5': return 0x79cf;
+            case '6': return 0x79ef;
+            case '7': return 0x7249;
+            case '8': return 0x7bef;
+            case '9': return 0x7bcf;
+            case 'A': return 0x2bed;
+            case 'B': return 0x6bae;
+            case 'C': return 0x3923;
+            case 'D': return 0x6b6e;
+            case 'E': return 0x79a7;
+            case 'F': return 0x79a4;
+            case 'G': return 0x396b;
+            case 'H': return 0x5bed;
+            case 'I': return 0x7497;
+            case 'J': return 0x126a;
+            case 'K': return 0x5bad;
+            case 'L': return 0x4927;
+            case 'M': return 0x5fed;
+            case 'N': return 0x6b6d;
+            case 'O': return 0x2b6a;
+            case 'P': return 0x6ba4;
+            case 'Q': return 0x2b73;
+            case 'R': return 0x6bad;
+            case 'S': return 0x388e;
+            case 'T': return 0x7492;
+            case 'U': return 0x5b6f;
+            case 'V': return 0x5b6a;
+            case 'W': return 0x5bfd;
+            case 'X': return 0x5aad;
+            case 'Y': return 0x5a92;
+            case 'Z': return 0x72a7;
+            case '.': return 0x0002;
+            case ':': return 0x0410;
+            case '%': return 0x52a5;
+            case '-': return 0x01c0;
+            case '/': return 0x12a4;
+            default:  return 0;
+            }
+        }
+
+        int graph_y(float ms)
+        {
+            float h = std::min(ms, GRAPH_MS) / GRAPH_MS * (GRAPH_H - 1);
+            return GRAPH_Y + GRAPH_H - 1 - static_cast<int>(h);
+        }
+
+        void hline(SDL_Renderer* renderer, float ms, const Color& c)
+        {
+            SDL_SetRenderDrawColor(renderer, c.r, c.g, c.b, c.a);
+            SDL_RenderDrawLine(renderer, GRAPH_X, graph_y(ms),
+                               GRAPH_X + GRAPH_W - 1, graph_y(ms));
+        }
+    }
+
+    Hud::Hud()
+    : _head(0), _count(0)
+    {
+        for (int i = 0; i < HUD_FRAMES; ++i)
+        {
+            _ms[i] = 0.0f;
+            _sorted[i] = 0.0f;
+        }
+        // Reserve enough for every line fully lit so that render() never
+        // allocates.
+        _glyphs.reserve(LINES * (GRAPH_W / (4 * SCALE) + 1) * 15);
+        _graph.reserve(HUD_FRAMES);
+    }
+
+    void Hud::push(double ms)
+    {
+        _ms[_head] = static_cast<float>(ms);
+        _head = (_head + 1) % HUD_FRAMES;
+        if (_count < HUD_FRAMES)
+            ++_count;
+    }
+
+    void Hud::render(SDL_Renderer* renderer, const RenderStats& stats)
+    {
+        uint8_t r, g, b, a;
+        SDL_BlendMode mode;
+        SDL_GetRenderDrawColor(renderer, &r, &g, &b, &a);
+        SDL_GetRenderDrawBlendMode(renderer, &mode);
+
+        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 180);
+        const SDL_Rect panel = { X, Y, PANEL_W, PANEL_H };
+        SDL_RenderFillRect(renderer, &panel);
+
+        // Percentiles and the graph, oldest frame on the left.
+        float last = 0.0f, total = 0.0f;
+        _graph.clear();
+        for (int i = 0; i < _count; ++i)
+        {
+            float ms = _ms[(_head - _count + i + HUD_FRAMES) % HUD_FRAMES];
+            _sorted[i] = ms;
+            total += ms;
+            last = ms;
+            Point p = { GRAPH_X + (HUD_FRAMES - _count + i) * 2, graph_y(ms) };
+            _graph.push_back(p);
+        }
+        std::sort(_sorted, _sorted + _count);
+
+        float p50 = 0.0f, p95 = 0.0f, p99 = 0.0f;
+        if (_count > 0)
+        {
+            p50 = _sorted[(_count - 1) * 50 / 100];
+            p95 = _sorted[(_count - 1) * 95 / 100];
+            p99 = _sorted[(_count - 1) * 99 / 100];
+        }
+        float fps = total > 0.0f ? 1000.0f * _count / total : 0.0f;
+
+        hline(renderer, TARGET_MS, DARKGRAY);
+        hline(renderer, p50, GREEN);
+        hline(renderer, p95, YELLOW);
+        hline(renderer, p99, RED);
+
+        if (_graph.size() >= 2)
+        {
+            SDL_SetRenderDrawColor(renderer, CYAN.r, CYAN.g, CYAN.b, CYAN.a);
+            SDL_RenderDrawLines(renderer, _graph.data(), _graph.size());
+        }
+
+        // All of the text goes out in a single batch.
+        char line[64];
+        int y = Y + PAD;
+        _glyphs.clear();
+        std::snprintf(line, sizeof(line), "FPS %.1f  MS %.2f", fps, last);
+        _text(X + PAD, y, line);
+        y += LINE;
+        std::snprintf(line, sizeof(line), "P50 %.1f P95 %.1f P99 %.1f", p50, p95, p99);
+        _text(X + PAD, y, line);
+        y += LINE;
+        std::snprintf(line, sizeof(line), "DRAW %u PRIM %u", stats.draw_calls, stats.primitives);
+        _text(X + PAD, y, line);
+        y += LINE;
+        std::snprintf(line, sizeof(line), "TEX %.1f MB", texture_memory() / (1024.0 * 1024.0));
+        _text(X + PAD, y, line);
+        _fill(renderer, WHITE);
+
+        SDL_SetRenderDrawBlendMode(renderer, mode);
+        SDL_SetRenderDrawColor(renderer, r, g, b, a);
+    }
+
+    //------------------------------------------------------------------------
+    // Private Functions - You cannot call these.
+    //------------------------------------------------------------------------
+
+    void Hud::_text(int x, int y, const char* s)
+    {
+        for (; *s && x + 3 * SCALE <= X + PANEL_W; ++s, x += 4 * SCALE)
+        {
+            uint16_t bits = glyph(*s);
+            for (int i = 0; i < 15; ++i)
+            {
+                if (bits & (1 << (14 - i)))
+                {
+                    Rect r = { x + (i % 3) * SCALE, y + (i / 3) * SCALE, SCALE, SCALE };
+                    _glyphs.push_back(r);
+                }
+            }
+        }
+    }
+
+    void Hud::_fill(SDL_Renderer* renderer, const Color& c)
+    {
+        SDL_SetRenderDrawColor(renderer, c.r, c.g, c.b, c.a);
+        if (!_glyphs.empty())
+            SDL_RenderFillRects(renderer, _glyphs.data(), _glyphs.size());
+    }
+}
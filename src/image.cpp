@@ -17,11 +17,34 @@
  */
 
 #include "image.h"
+#include "context.h"
 #include "window.h"
 #include "sdllib.h"
+#include "profile.h"
 
 namespace sdlx {
 
+    namespace {
+
+        size_t resident = 0;
+
+        size_t texture_bytes(SDL_Texture* texture)
+        {
+            Uint32 format;
+            int w, h;
+            if (texture == NULL
+                || SDL_QueryTexture(texture, &format, NULL, &w, &h) != 0)
+                return 0;
+            int bpp = SDL_ISPIXELFORMAT_FOURCC(format) ? 4 : SDL_BYTESPERPIXEL(format);
+            return static_cast<size_t>(w) * h * bpp;
+        }
+    }
+
+    size_t texture_memory()
+    {
+        return resident;
+    }
+
     /*****************************************************************************
     Class Font
     *****************************************************************************/
@@ -29,12 +52,46 @@ namespace sdlx {
     Font::Font(const std::string& fontfamily, size_t size)
     : _font(NULL)
     {
+        SDLX_ZONE("Font::Font");
+        context().require(INIT_TTF);
         _font = TTF_OpenFont(fontfamily.c_str(), size);
     }
 
+    Font::Font(Span file, size_t size)
+    : _font(NULL)
+    {
+        SDLX_ZONE("Font::Font(memory)");
+        if (file.data == NULL)
+            return;
+        context().require(INIT_TTF);
+        SDL_RWops* rw = SDL_RWFromConstMem(file.data, static_cast<int>(file.size));
+        _font = TTF_OpenFontRW(rw, 1, size);
+        if (_font == NULL)
+            std::cout << "Error in Font::Font(): " << TTF_GetError() << '\n';
+    }
+
+    Font::Font(Font&& other)
+    : _font(other._font)
+    {
+        other._font = NULL;
+    }
+
+    Font& Font::operator=(Font&& other)
+    {
+        if (this != &other)
+        {
+            if (_font != NULL)
+                TTF_CloseFont(_font);
+            _font = other._font;
+            other._font = NULL;
+        }
+        return *this;
+    }
+
     Font::~Font()
     {
-        TTF_CloseFont(_font);
+        if (_font != NULL)
+            TTF_CloseFont(_font);
     }
 
     TTF_Font* Font::get_font()
@@ -53,6 +110,8 @@ namespace sdlx {
     Image::Image(const std::string& filename, Window& window)
     : Image()
     {
+        SDLX_ZONE("Image::Image(file)");
+        context().require(INIT_IMAGE);
         _image = IMG_LoadTexture(window.get_renderer(), filename.c_str());
 
         if (_image == NULL)
@@ -61,21 +120,90 @@ namespace sdlx {
             exit(1);
         }
 
-        SDL_QueryTexture(_image, NULL, NULL, &_w, &_h);
+        _query();
+    }
+
+    Image::Image(Span file, Window& window)
+    : Image()
+    {
+        SDLX_ZONE("Image::Image(memory)");
+        context().require(INIT_IMAGE);
+        SDL_RWops* rw = SDL_RWFromConstMem(file.data, static_cast<int>(file.size));
+        _image = IMG_LoadTexture_RW(window.get_renderer(), rw, 1);
+        if (_image == NULL)
+        {
+            std::cout << "Error in Image::Image(): " << IMG_GetError() << '\n';
+            return;
+        }
+        _query();
     }
 
     Image::Image(const std::string& text, Font& font, const Color& c, Window& window)
     : Image()
     {
-        SDL_Color color = { c.r, c.b, c.g, c.a };
+        SDLX_ZONE("Image::Image(text)");
+        SDL_Color color = { c.r, c.g, c.b, c.a };
         SDL_Surface* s = TTF_RenderText_Solid(font.get_font(), text.c_str(), color);
+        if (s == NULL)
+        {
+            std::cout << "Error in Image::Image(): " << TTF_GetError() << '\n';
+            return;
+        }
         _image = SDL_CreateTextureFromSurface(window.get_renderer(), s);
-        SDL_QueryTexture(_image, NULL, NULL, &_w, &_h);
+        SDL_FreeSurface(s);
+        _query();
+    }
+
+    Image::Image(SDL_Surface* surface, Window& window)
+    : Image()
+    {
+        _image = SDL_CreateTextureFromSurface(window.get_renderer(), surface);
+        _query();
+    }
+
+    Image::Image(int w, int h, uint32_t format, const void* pixels, int pitch,
+                 Window& window)
+    : Image()
+    {
+        SDLX_ZONE("Image::Image(pixels)");
+        _image = SDL_CreateTexture(window.get_renderer(), format,
+                                   SDL_TEXTUREACCESS_STATIC, w, h);
+        if (_image == NULL
+            || SDL_UpdateTexture(_image, NULL, pixels, pitch) != 0)
+        {
+            std::cout << "Error in Image::Image(): " << SDL_GetError() << '\n';
+            _free();
+            return;
+        }
+        if (SDL_ISPIXELFORMAT_ALPHA(format))
+            SDL_SetTextureBlendMode(_image, SDL_BLENDMODE_BLEND);
+        _query();
+    }
+
+    Image::Image(Image&& other)
+    : _image(other._image), _w(other._w), _h(other._h)
+    {
+        other._image = NULL;
+        other._w = other._h = 0;
+    }
+
+    Image& Image::operator=(Image&& other)
+    {
+        if (this != &other)
+        {
+            _free();
+            _image = other._image;
+            _w = other._w;
+            _h = other._h;
+            other._image = NULL;
+            other._w = other._h = 0;
+        }
+        return *this;
     }
 
     Image::~Image()
     {
-        SDL_DestroyTexture(_image);
+        _free();
     }
 
     SDL_Texture* Image::get_texture()
@@ -93,9 +221,30 @@ namespace sdlx {
         return _h;
     }
 
+    size_t Image::get_bytes() const
+    {
+        return texture_bytes(_image);
+    }
+
     Rect Image::get_rect() const
     {
         return Rect { 0, 0, _w, _h };
     }
 
+    void Image::_query()
+    {
+        SDL_QueryTexture(_image, NULL, NULL, &_w, &_h);
+        resident += texture_bytes(_image);
+    }
+
+    void Image::_free()
+    {
+        if (_image != NULL)
+        {
+            resident -= texture_bytes(_image);
+            SDL_DestroyTexture(_image);
+            _image = NULL;
+        }
+    }
+
 }
\ No newline at end of file
@@ -0,0 +1,194 @@
+/*
+ * SDLX, a SDL graphics library for CS students.
+ * Copyright (C) 2017, Seth Kasmann, Yihsiang Liow
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <iostream>
+#include "loader.h"
+#include "context.h"
+#include "window.h"
+#include "sdllib.h"
+#include "profile.h"
+
+namespace sdlx {
+
+    //------------------------------------------------------------------------
+    // ImageHandle Class
+    //------------------------------------------------------------------------
+
+    ImageHandle::ImageHandle()
+    {}
+
+    bool ImageHandle::ready() const
+    {
+        return _state && _state->status == READY;
+    }
+
+    bool ImageHandle::failed() const
+    {
+        return _state && _state->status == FAILED;
+    }
+
+    bool ImageHandle::done() const
+    {
+        return ready() || failed();
+    }
+
+    const std::string& ImageHandle::filename() const
+    {
+        static const std::string none;
+        return _state ? _state->filename : none;
+    }
+
+    const std::string& ImageHandle::error() const
+    {
+        static const std::string none;
+        return failed() ? _state->error : none;
+    }
+
+    Image& ImageHandle::get()
+    {
+        // An empty Image draws nothing, so a handle that is not ready can
+        // still be drawn while reporting the mistake.
+        static Image none;
+        if (!ready())
+        {
+            std::cout << "Error in ImageHandle::get(): "
+                      << (filename().empty() ? std::string("Empty handle") : filename())
+                      << " is not ready\n";
+            return none;
+        }
+        return *_state->image;
+    }
+
+    //------------------------------------------------------------------------
+    // AssetLoader Class
+    //------------------------------------------------------------------------
+
+    AssetLoader::AssetLoader(Window& window, int threads)
+    : _window(window), _pending(0), _pool(threads)
+    {
+        context().require(INIT_IMAGE);
+    }
+
+    AssetLoader::~AssetLoader()
+    {
+        // Let the decoders finish before freeing what they made.
+        _pool.wait();
+        for (size_t i = 0; i < _decoded.size(); ++i)
+            SDL_FreeSurface(_decoded[i]->surface);
+    }
+
+    ImageHandle AssetLoader::load(const std::string& filename)
+    {
+        StatePtr state(new ImageHandle::State);
+        state->filename = filename;
+        state->surface = nullptr;
+        state->status = ImageHandle::LOADING;
+        ++_pending;
+
+        _pool.submit([this, state] { _decode(state); });
+
+        ImageHandle handle;
+        handle._state = state;
+        return handle;
+    }
+
+    int AssetLoader::update(double budget_ms)
+    {
+        SDLX_ZONE("AssetLoader::update");
+
+        const Uint64 start = SDL_GetPerformanceCounter();
+        const Uint64 budget = budget_ms * SDL_GetPerformanceFrequency() / 1000.0;
+
+        // At least one image is uploaded per call so loading always makes
+        // progress, even with a tiny budget.
+        int uploaded = 0;
+        do
+        {
+            StatePtr state;
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (_decoded.empty())
+                    break;
+                state = _decoded.front();
+                _decoded.pop_front();
+            }
+
+            state->image.reset(new Image(state->surface, _window));
+            SDL_FreeSurface(state->surface);
+            state->surface = nullptr;
+
+            if (state->image->get_texture() == nullptr)
+            {
+                state->error = SDL_GetError();
+                state->image.reset();
+                state->status = ImageHandle::FAILED;
+                std::cout << "Error in AssetLoader: " << state->filename << ": "
+                          << state->error << '\n';
+            }
+            else
+            {
+                state->status = ImageHandle::READY;
+            }
+            --_pending;
+            ++uploaded;
+        }
+        while (SDL_GetPerformanceCounter() - start < budget);
+
+        return uploaded;
+    }
+
+    void AssetLoader::finish()
+    {
+        while (_pending > 0)
+        {
+            if (update(1000.0) == 0)
+                SDL_Delay(1);
+        }
+    }
+
+    int AssetLoader::pending() const
+    {
+        return _pending;
+    }
+
+    //------------------------------------------------------------------------
+    // Private Functions - You cannot call these.
+    //------------------------------------------------------------------------
+
+    void AssetLoader::_decode(StatePtr state)
+    {
+        SDLX_ZONE("AssetLoader::decode");
+
+        state->surface = IMG_Load(state->filename.c_str());
+
+        if (state->surface == nullptr)
+        {
+            // SDL keeps one error message per thread, so this is ours.
+            state->error = IMG_GetError();
+            state->status = ImageHandle::FAILED;
+            --_pending;
+            std::cout << "Error in AssetLoader: " << state->filename << ": "
+                      << state->error << '\n';
+            return;
+        }
+
+        state->status = ImageHandle::DECODED;
+        std::lock_guard<std::mutex> lock(_mutex);
+        _decoded.push_back(state);
+    }
+}
@@ -0,0 +1,162 @@
+/*
+ * SDLX, a SDL graphics library for CS students.
+ * Copyright (C) 2017, Seth Kasmann, Yihsiang Liow
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <iostream>
+#include "mapped.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace sdlx {
+
+    MappedFile::MappedFile()
+    : _data(NULL), _size(0), _handle(NULL)
+    {}
+
+    MappedFile::MappedFile(const std::string& filename)
+    : MappedFile()
+    {
+        open(filename);
+    }
+
+    MappedFile::MappedFile(MappedFile&& other)
+    : _data(other._data), _size(other._size), _handle(other._handle)
+    {
+        other._data = NULL;
+        other._size = 0;
+        other._handle = NULL;
+    }
+
+    MappedFile& MappedFile::operator=(MappedFile&& other)
+    {
+        if (this != &other)
+        {
+            close();
+            _data = other._data;
+            _size = other._size;
+            _handle = other._handle;
+            other._data = NULL;
+            other._size = 0;
+            other._handle = NULL;
+        }
+        return *this;
+    }
+
+    MappedFile::~MappedFile()
+    {
+        close();
+    }
+
+    bool MappedFile::open(const std::string& filename)
+    {
+        close();
+    #ifdef _WIN32
+        HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                                  NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            std::cout << "Error in MappedFile::open(): Cannot open " << filename << '\n';
+            return false;
+        }
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+        {
+            std::cout << "Error in MappedFile::open(): " << filename << " is empty\n";
+            CloseHandle(file);
+            return false;
+        }
+        HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        CloseHandle(file);
+        if (mapping == NULL)
+        {
+            std::cout << "Error in MappedFile::open(): Cannot map " << filename << '\n';
+            return false;
+        }
+        void* p = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (p == NULL)
+        {
+            std::cout << "Error in MappedFile::open(): Cannot map " << filename << '\n';
+            CloseHandle(mapping);
+            return false;
+        }
+        _handle = mapping;
+        _size = static_cast<size_t>(size.QuadPart);
+    #else
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            std::cout << "Error in MappedFile::open(): Cannot open " << filename << '\n';
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0)
+        {
+            std::cout << "Error in MappedFile::open(): " << filename << " is empty\n";
+            ::close(fd);
+            return false;
+        }
+        void* p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        // The mapping keeps the file alive, the descriptor is not needed.
+        ::close(fd);
+        if (p == MAP_FAILED)
+        {
+            std::cout << "Error in MappedFile::open(): Cannot map " << filename << '\n';
+            return false;
+        }
+        _size = static_cast<size_t>(st.st_size);
+    #endif
+        _data = static_cast<const uint8_t*>(p);
+        return true;
+    }
+
+    void MappedFile::close()
+    {
+        if (_data == NULL)
+            return;
+    #ifdef _WIN32
+        UnmapViewOfFile(_data);
+        CloseHandle(static_cast<HANDLE>(_handle));
+    #else
+        munmap(const_cast<uint8_t*>(_data), _size);
+    #endif
+        _data = NULL;
+        _size = 0;
+        _handle = NULL;
+    }
+
+    bool MappedFile::is_open() const
+    {
+        return _data != NULL;
+    }
+
+    const uint8_t* MappedFile::data() const
+    {
+        return _data;
+    }
+
+    size_t MappedFile::size() const
+    {
+        return _size;
+    }
+}
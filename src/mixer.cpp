@@ -0,0 +1,561 @@
+/*
+ * SDLX, a SDL graphics library for CS students.
+ * Copyright (C) 2017, Seth Kasmann, Yihsiang Liow
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include "mixer.h"
+#include "sdllib.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SDLX_SSE2
+#include <emmintrin.h>
+#if defined(__GNUC__) || defined(_MSC_VER)
+#define SDLX_AVX2
+#include <immintrin.h>
+#endif
+#endif
+
+#if defined(SDLX_AVX2) && defined(__GNUC__)
+#define SDLX_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define SDLX_TARGET_AVX2
+#endif
+
+namespace sdlx {
+
+    namespace {
+
+        uint64_t now_ns()
+        {
+            using namespace std::chrono;
+            return duration_cast<nanoseconds>(
+                steady_clock::now().time_since_epoch()).count();
+        }
+
+        // Voice ids carry the index in the low 8 bits so that a command for
+        // a voice that has since been given to another sound does nothing.
+        const int INDEX_BITS = 8;
+        const int INDEX_MASK = MIXER_VOICES - 1;
+
+        //--------------------------------------------------------------------
+        // Kernels. out and in are interleaved stereo, frames long. left and
+        // right are the gains of the two channels.
+        //--------------------------------------------------------------------
+
+        void add_scalar(float* out, const float* in, int frames, float left, float right)
+        {
+            for (int i = 0; i < frames; ++i)
+            {
+                out[2 * i] += in[2 * i] * left;
+                out[2 * i + 1] += in[2 * i + 1] * right;
+            }
+        }
+
+        void clamp_scalar(float* out, int n)
+        {
+            for (int i = 0; i < n; ++i)
+                out[i] = std::min(1.0f, std::max(-1.0f, out[i]));
+        }
+
+#ifdef SDLX_SSE2
+        // Two frames per register.
+        void add_sse2(float* out, const float* in, int frames, float left, float right)
+        {
+            const __m128 gain = _mm_set_ps(right, left, right, left);
+            int i = 0;
+            for (; i + 2 <= frames; i += 2)
+            {
+                __m128 s = _mm_mul_ps(_mm_loadu_ps(in + 2 * i), gain);
+                _mm_storeu_ps(out + 2 * i, _mm_add_ps(_mm_loadu_ps(out + 2 * i), s));
+            }
+            add_scalar(out + 2 * i, in + 2 * i, frames - i, left, right);
+        }
+
+        void clamp_sse2(float* out, int n)
+        {
+            const __m128 lo = _mm_set1_ps(-1.0f);
+            const __m128 hi = _mm_set1_ps(1.0f);
+            int i = 0;
+            for (; i + 4 <= n; i += 4)
+                _mm_storeu_ps(out + i, _mm_min_ps(hi, _mm_max_ps(lo, _mm_loadu_ps(out + i))));
+            clamp_scalar(out + i, n - i);
+        }
+#endif
+
+#ifdef SDLX_AVX2
+        // Four frames per register.
+        SDLX_TARGET_AVX2
+        void add_avx2(float* out, const float* in, int frames, float left, float right)
+        {
+            const __m256 gain = _mm256_set_ps(right, left, right, left,
+                                              right, left, right, left);
+            int i = 0;
+            for (; i + 4 <= frames; i += 4)
+            {
+                __m256 s = _mm256_mul_ps(_mm256_loadu_ps(in + 2 * i), gain);
+                _mm256_storeu_ps(out + 2 * i,
+                                 _mm256_add_ps(_mm256_loadu_ps(out + 2 * i), s));
+            }
+            add_scalar(out + 2 * i, in + 2 * i, frames - i, left, right);
+        }
+
+        SDLX_TARGET_AVX2
+        void clamp_avx2(float* out, int n)
+        {
+            const __m256 lo = _mm256_set1_ps(-1.0f);
+            const __m256 hi = _mm256_set1_ps(1.0f);
+            int i = 0;
+            for (; i + 8 <= n; i += 8)
+                _mm256_storeu_ps(out + i,
+                                 _mm256_min_ps(hi, _mm256_max_ps(lo, _mm256_loadu_ps(out + i))));
+            clamp_scalar(out + i, n - i);
+        }
+#endif
+
+        struct Kernels
+        {
+            void (*add)(float* out, const float* in, int frames, float left, float right);
+            void (*clamp)(float* out, int n);
+            const char* name;
+        };
+
+        // The best kernels this CPU can run, chosen once.
+        const Kernels& kernels()
+        {
+            static const Kernels k = []()
+            {
+                Kernels k = { add_scalar, clamp_scalar, "scalar" };
+#ifdef SDLX_SSE2
+                if (SDL_HasSSE2())
+                {
+                    k.add = add_sse2;
+                    k.clamp = clamp_sse2;
+                    k.name = "sse2";
+                }
+#endif
+#ifdef SDLX_AVX2
+                if (SDL_HasAVX2())
+                {
+                    k.add = add_avx2;
+                    k.clamp = clamp_avx2;
+                    k.name = "avx2";
+                }
+#endif
+                return k;
+            }();
+            return k;
+        }
+
+        // Left and right gains for a volume and a pan from -1 to 1.
+        void gains(float volume, float pan, float& left, float& right)
+        {
+            left = volume * (pan > 0.0f ? 1.0f - pan : 1.0f);
+            right = volume * (pan < 0.0f ? 1.0f + pan : 1.0f);
+        }
+
+        float volume_of(int volume, const Mix_Chunk* chunk)
+        {
+            return float(volume) / MIX_MAX_VOLUME * float(chunk->volume) / MIX_MAX_VOLUME;
+        }
+    }
+
+    NativeMixer::NativeMixer()
+    : _steal(STEAL_OLDEST), _generation(0), _frequency(0), _open(false),
+      _head(0), _tail(0), _dropped(0),
+      _callbacks(0), _mix_ns(0), _mix_total_ns(0), _mix_max_ns(0), _active(0)
+    {
+        const Slot none = { NULL, 0, 0, 0, 0, 0 };
+        const Voice silent = { NULL, 0, 0, 0.0f, 0.0f, 0 };
+        for (int i = 0; i < MIXER_VOICES; ++i)
+        {
+            _slots[i] = none;
+            _voices[i] = silent;
+        }
+    }
+
+    NativeMixer::~NativeMixer()
+    {
+        close();
+    }
+
+    // The AudioDevice has opened SDL_mixer in float stereo at frequency and
+    // calls mix() from its post-mix hook from now on.
+    void NativeMixer::open(int frequency)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_open)
+            return;
+
+        Mix_LockAudio();
+        _frequency = frequency;
+        _head = 0;
+        _tail = 0;
+        _dropped = 0;
+        _callbacks = 0;
+        _mix_ns = 0;
+        _mix_total_ns = 0;
+        _mix_max_ns = 0;
+        _active = 0;
+        for (int i = 0; i < MIXER_VOICES; ++i)
+        {
+            _slots[i].chunk = NULL;
+            _voices[i].samples = NULL;
+        }
+        _last.clear();
+        kernels();
+        _open = true;
+        Mix_UnlockAudio();
+    }
+
+    void NativeMixer::close()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_open)
+            return;
+        Mix_LockAudio();
+        _open = false;
+        for (int i = 0; i < MIXER_VOICES; ++i)
+        {
+            _slots[i].chunk = NULL;
+            _voices[i].samples = NULL;
+        }
+        Mix_UnlockAudio();
+        _last.clear();
+    }
+
+    bool NativeMixer::is_open() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _open;
+    }
+
+    void NativeMixer::set_steal(Steal steal)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _steal = steal;
+    }
+
+    int NativeMixer::play(Mix_Chunk* chunk, const VoiceParams& params, float pan)
+    {
+        if (chunk == NULL)
+            return -1;
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_open)
+            return -1;
+        const uint32_t now = SDL_GetTicks();
+
+        std::unordered_map<Mix_Chunk*, uint32_t>::iterator last = _last.find(chunk);
+        if (last != _last.end() && now - last->second < params.coalesce)
+            return -1;
+
+        const int i = _choose(chunk, params, now);
+        if (i < 0)
+            return -1;
+
+        _generation = (_generation + 1) & 0x7fffff;
+        const uint32_t frames = chunk->alen / (2 * sizeof(float));
+        Command c;
+        c.type = PLAY;
+        c.voice = (_generation << INDEX_BITS) | i;
+        c.samples = reinterpret_cast<const float*>(chunk->abuf);
+        c.frames = frames;
+        c.volume = volume_of(params.volume, chunk);
+        c.pan = std::min(1.0f, std::max(-1.0f, pan));
+        if (!_push(c))
+            return -1;
+
+        Slot& s = _slots[i];
+        s.chunk = chunk;
+        s.priority = params.priority;
+        s.volume = params.volume;
+        s.id = c.voice;
+        s.start = now;
+        s.end = now + uint32_t(uint64_t(frames) * 1000 / _frequency) + 1;
+        _last[chunk] = now;
+        return c.voice;
+    }
+
+    // The chunk is usually freed right after this, so the audio thread
+    // must be done with it before stop() returns. Locking the device keeps
+    // the callback out while the queue is drained here instead.
+    void NativeMixer::stop(Mix_Chunk* chunk)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_open || chunk == NULL)
+            return;
+
+        Mix_LockAudio();
+        _drain();
+        Command c;
+        c.type = STOP_SAMPLE;
+        c.voice = -1;
+        c.samples = reinterpret_cast<const float*>(chunk->abuf);
+        c.frames = 0;
+        c.volume = 0.0f;
+        c.pan = 0.0f;
+        _apply(c);
+        Mix_UnlockAudio();
+
+        for (int i = 0; i < MIXER_VOICES; ++i)
+            if (_slots[i].chunk == chunk)
+                _slots[i].chunk = NULL;
+        _last.erase(chunk);
+    }
+
+    void NativeMixer::stop_voice(int voice)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        Slot& s = _slots[voice & INDEX_MASK];
+        if (!_open || voice < 0 || s.id != voice)
+            return;
+        Command c;
+        c.type = STOP;
+        c.voice = voice;
+        c.samples = NULL;
+        c.frames = 0;
+        c.volume = 0.0f;
+        c.pan = 0.0f;
+        if (_push(c))
+            s.chunk = NULL;
+    }
+
+    void NativeMixer::set_volume(int voice, int volume)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        Slot& s = _slots[voice & INDEX_MASK];
+        if (!_open || voice < 0 || s.id != voice || s.chunk == NULL)
+            return;
+        Command c;
+        c.type = VOLUME;
+        c.voice = voice;
+        c.samples = NULL;
+        c.frames = 0;
+        c.volume = volume_of(volume, s.chunk);
+        c.pan = 0.0f;
+        if (_push(c))
+            s.volume = volume;
+    }
+
+    void NativeMixer::set_pan(int voice, float pan)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        Slot& s = _slots[voice & INDEX_MASK];
+        if (!_open || voice < 0 || s.id != voice)
+            return;
+        Command c;
+        c.type = PAN;
+        c.voice = voice;
+        c.samples = NULL;
+        c.frames = 0;
+        c.volume = 0.0f;
+        c.pan = std::min(1.0f, std::max(-1.0f, pan));
+        _push(c);
+    }
+
+    // As far as the game thread knows; the voice may end a few ms later.
+    bool NativeMixer::playing(int voice) const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        const int i = voice & INDEX_MASK;
+        return voice >= 0 && _slots[i].id == voice && _busy(i, SDL_GetTicks());
+    }
+
+    int NativeMixer::active() const
+    {
+        return _active.load(std::memory_order_relaxed);
+    }
+
+    // Adds every voice to a buffer SDL_mixer has mixed. Runs in the audio
+    // thread, from the AudioDevice's post-mix hook.
+    void NativeMixer::mix(uint8_t* stream, int bytes)
+    {
+        if (!_open)
+            return;
+        const uint64_t start = now_ns();
+        _drain();
+        _render(reinterpret_cast<float*>(stream), bytes / (2 * sizeof(float)));
+
+        const uint64_t ns = now_ns() - start;
+        _mix_ns.store(ns, std::memory_order_relaxed);
+        _mix_total_ns.fetch_add(ns, std::memory_order_relaxed);
+        if (ns > _mix_max_ns.load(std::memory_order_relaxed))
+            _mix_max_ns.store(ns, std::memory_order_relaxed);
+        _callbacks.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    MixerStats NativeMixer::stats() const
+    {
+        MixerStats s;
+        s.callbacks = _callbacks.load(std::memory_order_relaxed);
+        s.mix_ms = _mix_ns.load(std::memory_order_relaxed) / 1e6;
+        s.mix_ms_avg = s.callbacks > 0
+            ? _mix_total_ns.load(std::memory_order_relaxed) / 1e6 / s.callbacks : 0.0;
+        s.mix_ms_max = _mix_max_ns.load(std::memory_order_relaxed) / 1e6;
+        s.voices = _active.load(std::memory_order_relaxed);
+        s.dropped = _dropped.load(std::memory_order_relaxed);
+        s.simd = kernels().name;
+        return s;
+    }
+
+    //------------------------------------------------------------------------
+    // Private Functions - You cannot call these.
+    //------------------------------------------------------------------------
+
+    // Called with _mutex held, so there is only ever one producer.
+    bool NativeMixer::_push(const Command& c)
+    {
+        const uint32_t head = _head.load(std::memory_order_relaxed);
+        if (head - _tail.load(std::memory_order_acquire) >= uint32_t(MIXER_COMMANDS))
+        {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        _queue[head % MIXER_COMMANDS] = c;
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Run by the audio thread, or by stop() while the device is locked.
+    void NativeMixer::_drain()
+    {
+        uint32_t tail = _tail.load(std::memory_order_relaxed);
+        const uint32_t head = _head.load(std::memory_order_acquire);
+        for (; tail != head; ++tail)
+            _apply(_queue[tail % MIXER_COMMANDS]);
+        _tail.store(tail, std::memory_order_release);
+    }
+
+    // The game thread's estimate: a voice is busy until its sample would
+    // have finished.
+    bool NativeMixer::_busy(int i, uint32_t now) const
+    {
+        return _slots[i].chunk != NULL && int32_t(now - _slots[i].end) < 0;
+    }
+
+    // Same rules as VoicePool::_choose().
+    int NativeMixer::_choose(Mix_Chunk* chunk, const VoiceParams& params, uint32_t now)
+    {
+        if (params.limit > 0)
+        {
+            int count = 0, oldest = -1;
+            for (int i = 0; i < MIXER_VOICES; ++i)
+            {
+                if (_slots[i].chunk != chunk || !_busy(i, now))
+                    continue;
+                ++count;
+                if (oldest < 0 || int32_t(_slots[i].start - _slots[oldest].start) < 0)
+                    oldest = i;
+            }
+            if (count >= params.limit)
+                return oldest;
+        }
+
+        for (int i = 0; i < MIXER_VOICES; ++i)
+            if (!_busy(i, now))
+                return i;
+
+        if (_steal == STEAL_NONE)
+            return -1;
+
+        int best = -1;
+        int best_loudness = 0;
+        for (int i = 0; i < MIXER_VOICES; ++i)
+        {
+            const Slot& v = _slots[i];
+            if (v.priority > params.priority)
+                continue;
+            const int loudness = v.volume * v.chunk->volume;
+            if (best >= 0)
+            {
+                const Slot& b = _slots[best];
+                if (v.priority != b.priority)
+                {
+                    if (v.priority > b.priority)
+                        continue;
+                }
+                else if (_steal == STEAL_QUIETEST && loudness != best_loudness)
+                {
+                    if (loudness > best_loudness)
+                        continue;
+                }
+                else if (int32_t(v.start - b.start) >= 0)
+                    continue;
+            }
+            best = i;
+            best_loudness = loudness;
+        }
+        return best;
+    }
+
+    void NativeMixer::_apply(const Command& c)
+    {
+        if (c.type == STOP_SAMPLE)
+        {
+            for (int i = 0; i < MIXER_VOICES; ++i)
+                if (_voices[i].samples == c.samples)
+                    _voices[i].samples = NULL;
+            return;
+        }
+
+        Voice& v = _voices[c.voice & INDEX_MASK];
+        if (c.type == PLAY)
+        {
+            v.samples = c.samples;
+            v.frames = c.frames;
+            v.position = 0;
+            v.volume = c.volume;
+            v.pan = c.pan;
+            v.id = c.voice;
+            return;
+        }
+        if (v.id != c.voice || v.samples == NULL)
+            return;
+        if (c.type == STOP)
+            v.samples = NULL;
+        else if (c.type == VOLUME)
+            v.volume = c.volume;
+        else if (c.type == PAN)
+            v.pan = c.pan;
+    }
+
+    // out already holds what SDL_mixer mixed: music and its own channels.
+    void NativeMixer::_render(float* out, int frames)
+    {
+        const Kernels& k = kernels();
+
+        int active = 0;
+        for (int i = 0; i < MIXER_VOICES; ++i)
+        {
+            Voice& v = _voices[i];
+            if (v.samples == NULL)
+                continue;
+            ++active;
+            const int n = std::min<uint32_t>(frames, v.frames - v.position);
+            float left, right;
+            gains(v.volume, v.pan, left, right);
+            k.add(out, v.samples + 2 * v.position, n, left, right);
+            v.position += n;
+            if (v.position >= v.frames)
+                v.samples = NULL;
+        }
+        k.clamp(out, frames * 2);
+        _active.store(active, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,196 @@
+/*
+ * SDLX, a SDL graphics library for CS students.
+ * Copyright (C) 2017, Seth Kasmann, Yihsiang Liow
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+#include <iostream>
+#include "pack.h"
+#include "rwops.h"
+#include "window.h"
+#include "sdllib.h"
+#include "profile.h"
+
+namespace sdlx {
+
+    namespace {
+
+        // True if the pixel rectangle of an image or region lies inside its
+        // payload, so the Image made from it never reads past the file.
+        bool pixels_fit(const PackEntry& e)
+        {
+            const uint64_t row = uint64_t(e.width) * SDL_BYTESPERPIXEL(e.format);
+            return e.height > 0 && e.pitch >= row
+                && (uint64_t(e.height) - 1) * e.pitch + row <= e.size;
+        }
+
+        // True if a region lies inside its atlas page.
+        bool region_fits(const PackEntry& e, const PackEntry& page)
+        {
+            return page.type == PACK_IMAGE && page.pitch == e.pitch
+                && uint64_t(e.x) + e.width <= page.width
+                && uint64_t(e.y) + e.height <= page.height;
+        }
+    }
+
+    Pack::Pack(const std::string& filename)
+    : _entries(NULL), _count(0)
+    {
+        SDLX_ZONE("Pack::Pack");
+        if (!_file.open(filename))
+            return;
+
+        const PackHeader* header = reinterpret_cast<const PackHeader*>(_file.data());
+        if (_file.size() < sizeof(PackHeader)
+            || std::memcmp(header->magic, "SDLXPAK", 8) != 0
+            || header->version != PACK_VERSION
+            || _file.size() < sizeof(PackHeader) + header->count * sizeof(PackEntry))
+        {
+            std::cout << "Error in Pack::Pack(): " << filename
+                      << " is not a version " << PACK_VERSION << " pack\n";
+            _file.close();
+            return;
+        }
+
+        _entries = reinterpret_cast<const PackEntry*>(header + 1);
+        _count = header->count;
+        for (uint32_t i = 0; i < _count; ++i)
+        {
+            const PackEntry& e = _entries[i];
+            if (e.name[PACK_NAME - 1] != '\0'
+                || e.offset > _file.size() || e.size > _file.size() - e.offset
+                || (e.type == PACK_REGION
+                    && (e.atlas >= _count || !region_fits(e, _entries[e.atlas])))
+                || ((e.type == PACK_IMAGE || e.type == PACK_REGION) && !pixels_fit(e)))
+            {
+                std::cout << "Error in Pack::Pack(): Bad entry " << i << " in "
+                          << filename << '\n';
+                continue;
+            }
+            _index[e.name] = &e;
+        }
+    }
+
+    bool Pack::is_open() const
+    {
+        return _file.is_open();
+    }
+
+    size_t Pack::size() const
+    {
+        return _index.size();
+    }
+
+    const PackEntry* Pack::find(const std::string& name) const
+    {
+        std::unordered_map<std::string, const PackEntry*>::const_iterator p
+            = _index.find(name);
+        return p == _index.end() ? NULL : p->second;
+    }
+
+    const uint8_t* Pack::data(const PackEntry& entry) const
+    {
+        return _file.data() + entry.offset;
+    }
+
+    Image Pack::image(const std::string& name, Window& window) const
+    {
+        const PackEntry* e = _get(name, PACK_IMAGE);
+        if (e == NULL)
+            return Image();
+        return Image(e->width, e->height, e->format, data(*e), e->pitch, window);
+    }
+
+    Font Pack::font(const std::string& name, size_t size) const
+    {
+        const PackEntry* e = _get(name, PACK_FONT);
+        if (e == NULL)
+        {
+            Span none = { NULL, 0 };
+            return Font(none, size);
+        }
+        return Font(_span(*e), size);
+    }
+
+    const PackEntry* Pack::atlas(const std::string& name, Rect& src) const
+    {
+        const PackEntry* e = _get(name, PACK_IMAGE);
+        if (e == NULL)
+            return NULL;
+        src.w = e->width;
+        src.h = e->height;
+        if (e->type != PACK_REGION)
+        {
+            src.x = src.y = 0;
+            return e;
+        }
+        src.x = e->x;
+        src.y = e->y;
+        return &_entries[e->atlas];
+    }
+
+    Sound Pack::sound(const std::string& name) const
+    {
+        const PackEntry* e = _get(name, PACK_SOUND);
+        if (e == NULL)
+            return Sound();
+        if (e->type == PACK_FILE)
+            return Sound(rw_from_span(_span(*e)));
+        return Sound(data(*e), e->size, e->width, e->format, e->height);
+    }
+
+    Music Pack::music(const std::string& name) const
+    {
+        const PackEntry* e = _get(name, PACK_FILE);
+        if (e == NULL)
+            return Music();
+        return Music(rw_from_span(_span(*e)));
+    }
+
+    SDL_RWops* Pack::rwops(const std::string& name) const
+    {
+        const PackEntry* e = _get(name, PACK_FILE);
+        if (e == NULL)
+            return NULL;
+        return rw_from_span(_span(*e));
+    }
+
+    //------------------------------------------------------------------------
+    // Private Functions - You cannot call these.
+    //------------------------------------------------------------------------
+
+    Span Pack::_span(const PackEntry& entry) const
+    {
+        Span file = { data(entry), static_cast<size_t>(entry.size) };
+        return file;
+    }
+
+    const PackEntry* Pack::_get(const std::string& name, PackType type) const
+    {
+        const PackEntry* e = find(name);
+        if (e == NULL)
+            std::cout << "Error in Pack: No asset " << name << '\n';
+        else if (e->type != static_cast<uint32_t>(type)
+                 && !(type == PACK_IMAGE && e->type == PACK_REGION)
+                 && !(type == PACK_SOUND && e->type == PACK_FILE))
+        {
+            std::cout << "Error in Pack: " << name << " is not of type "
+                      << type << '\n';
+            e = NULL;
+        }
+        return e;
+    }
+}
@@ -0,0 +1,153 @@
+/*
+ * SDLX, a SDL graphics library for CS students.
+ * Copyright (C) 2017, Seth Kasmann, Yihsiang Liow
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <iostream>
+#include <sstream>
+#include "audio.h"
+#include "files.h"
+#include "pcm.h"
+#include "sdllib.h"
+#include "profile.h"
+
+namespace sdlx {
+
+    bool convert_pcm(const void* pcm, size_t bytes, int frequency,
+                     uint16_t format, int channels, const AudioConfig& to,
+                     std::vector<uint8_t>& out)
+    {
+        const uint8_t* p = static_cast<const uint8_t*>(pcm);
+        if (frequency == to.frequency && format == to.format
+            && channels == to.channels)
+        {
+            out.assign(p, p + bytes);
+            return true;
+        }
+
+        // Streams resample with SDL_HINT_AUDIO_RESAMPLING_MODE, which the
+        // AudioDevice sets when it opens.
+        SDL_AudioStream* stream = SDL_NewAudioStream(
+            format, channels, frequency, to.format, to.channels, to.frequency);
+        if (stream == nullptr
+            || SDL_AudioStreamPut(stream, pcm, static_cast<int>(bytes)) != 0
+            || SDL_AudioStreamFlush(stream) != 0)
+        {
+            std::cout << "Error in convert_pcm(): " << SDL_GetError() << std::endl;
+            SDL_FreeAudioStream(stream);
+            return false;
+        }
+        out.resize(SDL_AudioStreamAvailable(stream));
+        const int got = SDL_AudioStreamGet(stream, out.data(), out.size());
+        out.resize(got > 0 ? got : 0);
+        SDL_FreeAudioStream(stream);
+        return true;
+    }
+
+    bool decode_pcm(const char* filename, const AudioConfig& to,
+                    std::vector<uint8_t>& out)
+    {
+        SDLX_ZONE("decode_pcm");
+        SDL_AudioSpec spec;
+        Uint8* buffer = nullptr;
+        Uint32 length = 0;
+        if (SDL_LoadWAV(filename, &spec, &buffer, &length) != nullptr)
+        {
+            const bool ok = convert_pcm(buffer, length, spec.freq, spec.format,
+                                        spec.channels, to, out);
+            SDL_FreeWAV(buffer);
+            return ok;
+        }
+
+        // Not a WAV. SDL_mixer decodes it to the device format.
+        Mix_Chunk* chunk = Mix_LoadWAV(filename);
+        if (chunk == nullptr)
+        {
+            std::cout << "Error in decode_pcm(): " << filename << ": "
+                      << Mix_GetError() << std::endl;
+            return false;
+        }
+        out.assign(chunk->abuf, chunk->abuf + chunk->alen);
+        Mix_FreeChunk(chunk);
+        return true;
+    }
+
+    PcmCache::PcmCache()
+    {}
+
+    PcmBuffer PcmCache::get(const std::string& filename, const AudioConfig& spec)
+    {
+        std::ostringstream key;
+        key << canonical_path(filename) << '@' << spec.frequency << '/'
+            << spec.format << '/' << spec.channels << '/' << spec.resample;
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            PcmBuffer p = _buffers[key.str()].lock();
+            if (p)
+                return p;
+        }
+
+        // Decoded without the lock so that other files load meanwhile. Two
+        // threads asking for the same file both decode it; one copy is kept.
+        std::shared_ptr<std::vector<uint8_t> > p(new std::vector<uint8_t>);
+        if (!decode_pcm(filename.c_str(), spec, *p))
+            return PcmBuffer();
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::weak_ptr<const std::vector<uint8_t> >& slot = _buffers[key.str()];
+        PcmBuffer other = slot.lock();
+        if (other)
+            return other;
+        slot = p;
+        return p;
+    }
+
+    size_t PcmCache::size() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        size_t n = 0;
+        for (auto& b : _buffers)
+            n += !b.second.expired();
+        return n;
+    }
+
+    size_t PcmCache::bytes() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        size_t n = 0;
+        for (auto& b : _buffers)
+        {
+            PcmBuffer p = b.second.lock();
+            if (p)
+                n += p->size();
+        }
+        return n;
+    }
+
+    // Forgets the files nothing uses anymore.
+    void PcmCache::purge()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto i = _buffers.begin(); i != _buffers.end();)
+        {
+            if (i->second.expired())
+                i = _buffers.erase(i);
+            else
+                ++i;
+        }
+    }
+}
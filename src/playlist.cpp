@@ -0,0 +1,277 @@
+/*
+ * SDLX, a SDL graphics library for CS students.
+ * Copyright (C) 2017, Seth Kasmann, Yihsiang Liow
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include "playlist.h"
+#include "context.h"
+#include "sdllib.h"
+#include "profile.h"
+
+namespace sdlx {
+
+    namespace {
+
+        // The playlist's channels, after the one decoded Music uses.
+        const int CHANNELS[2] = { 1, 2 };
+
+        const int NONE = -1;
+    }
+
+    Playlist::Playlist()
+    : _pending(NONE), _crossfade(2000), _loop(true), _volume(MIX_MAX_VOLUME),
+      _audio(context().audio().acquire()), _want(NONE), _ready(false),
+      _generation(0), _pool(1)
+    {
+        const Track none = { NONE, CHANNELS[0], PcmBuffer(), nullptr, 0, 0 };
+        _playing = none;
+        _fading = none;
+    }
+
+    Playlist::~Playlist()
+    {
+        _pool.wait();
+        _free(_playing);
+        _free(_fading);
+        if (_audio)
+            context().audio().release();
+    }
+
+    void Playlist::add(const std::string& filename)
+    {
+        _files.push_back(filename);
+    }
+
+    void Playlist::clear()
+    {
+        stop();
+        _files.clear();
+
+        // Track numbers now mean other files, so forget what was decoded
+        // and what is still being decoded.
+        std::lock_guard<std::mutex> lock(_mutex);
+        ++_generation;
+        _want = NONE;
+        _ready = false;
+        _decoded.reset();
+    }
+
+    size_t Playlist::size() const
+    {
+        return _files.size();
+    }
+
+    void Playlist::set_crossfade(int ms)
+    {
+        _crossfade = ms > 0 ? ms : 0;
+    }
+
+    void Playlist::set_loop(bool loop)
+    {
+        _loop = loop;
+    }
+
+    void Playlist::set_volume(int volume)
+    {
+        _volume = volume;
+        if (_audio)
+        {
+            Mix_Volume(CHANNELS[0], volume);
+            Mix_Volume(CHANNELS[1], volume);
+        }
+    }
+
+    void Playlist::play(int track)
+    {
+        if (!_audio || track < 0 || track >= int(_files.size()))
+            return;
+        _pending = track;
+        _prefetch(track);
+        update();
+    }
+
+    void Playlist::next()
+    {
+        if (_files.empty())
+            return;
+        play(_playing.index == NONE ? 0 : (_playing.index + 1) % _files.size());
+    }
+
+    void Playlist::stop(int fade_ms)
+    {
+        _pending = NONE;
+        if (_playing.chunk == nullptr)
+            return;
+        _free(_fading);
+        if (fade_ms > 0)
+            Mix_FadeOutChannel(_playing.channel, fade_ms);
+        else
+            Mix_HaltChannel(_playing.channel);
+        _fading = _playing;
+        _playing.index = NONE;
+        _playing.pcm.reset();
+        _playing.chunk = nullptr;
+    }
+
+    void Playlist::update()
+    {
+        SDLX_ZONE("Playlist::update");
+        if (!_audio)
+            return;
+
+        if (_fading.chunk != nullptr && !Mix_Playing(_fading.channel))
+            _free(_fading);
+
+        // Near the end of a track, move on to the next one.
+        const uint32_t now = SDL_GetTicks();
+        if (_pending == NONE && _playing.chunk != nullptr)
+        {
+            const int next = _following(_playing.index);
+            const uint32_t fade = std::min<uint32_t>(_crossfade, _playing.length);
+            if (next != NONE && next != _playing.index
+                && now - _playing.start >= _playing.length - fade)
+            {
+                _pending = next;
+            }
+        }
+        if (_playing.chunk != nullptr && !Mix_Playing(_playing.channel))
+            _free(_playing);
+
+        if (_pending == NONE)
+            return;
+        std::unique_lock<std::mutex> lock(_mutex);
+        if (_want != _pending || !_ready)
+            return;
+        lock.unlock();
+        _start();
+    }
+
+    int Playlist::current() const
+    {
+        return _playing.index;
+    }
+
+    bool Playlist::is_playing() const
+    {
+        return _playing.chunk != nullptr;
+    }
+
+    //------------------------------------------------------------------------
+    // Private Functions - You cannot call these.
+    //------------------------------------------------------------------------
+
+    int Playlist::_following(int track) const
+    {
+        if (track + 1 < int(_files.size()))
+            return track + 1;
+        return _loop && !_files.empty() ? 0 : NONE;
+    }
+
+    // Decodes a track on the worker thread, unless it is already there.
+    void Playlist::_prefetch(int track)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_want == track)
+            return;
+        _want = track;
+        _ready = false;
+        _decoded.reset();
+
+        const std::string filename = _files[track];
+        const int generation = _generation;
+        _pool.submit([this, track, filename, generation] {
+            AudioDevice& audio = context().audio();
+            PcmBuffer pcm = audio.pcm().get(filename, audio.spec());
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_generation == generation && _want == track)
+            {
+                _decoded = pcm;
+                _ready = true;
+            }
+        });
+    }
+
+    // Crossfades from the playing track to the decoded one.
+    void Playlist::_start()
+    {
+        const int track = _pending;
+        _pending = NONE;
+
+        PcmBuffer pcm;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            pcm = _decoded;
+        }
+        Mix_Chunk* chunk = nullptr;
+        if (pcm)
+            chunk = Mix_QuickLoad_RAW(const_cast<Uint8*>(pcm->data()),
+                                      static_cast<Uint32>(pcm->size()));
+        if (chunk == nullptr)
+        {
+            // decode_pcm() said why. Keep playing what plays.
+            std::lock_guard<std::mutex> lock(_mutex);
+            _want = NONE;
+            return;
+        }
+
+        _free(_fading);
+        const int channel = _playing.channel == CHANNELS[0] ? CHANNELS[1] : CHANNELS[0];
+        if (_playing.chunk != nullptr)
+        {
+            if (_crossfade > 0)
+                Mix_FadeOutChannel(_playing.channel, _crossfade);
+            else
+                Mix_HaltChannel(_playing.channel);
+            _fading = _playing;
+        }
+
+        // Every track loops until the next one takes over, so a late
+        // decode never leaves silence.
+        const int loops = _following(track) == NONE ? 0 : -1;
+        Mix_Volume(channel, _volume);
+        if (_crossfade > 0 && _fading.chunk != nullptr)
+            Mix_FadeInChannel(channel, chunk, loops, _crossfade);
+        else
+            Mix_PlayChannel(channel, chunk, loops);
+
+        const AudioConfig spec = context().audio().spec();
+        const uint64_t rate = uint64_t(spec.frequency) * spec.channels
+                              * (SDL_AUDIO_BITSIZE(spec.format) / 8);
+        _playing.index = track;
+        _playing.channel = channel;
+        _playing.pcm = pcm;
+        _playing.chunk = chunk;
+        _playing.start = SDL_GetTicks();
+        _playing.length = rate > 0 ? uint32_t(pcm->size() * 1000 / rate) : 0;
+
+        const int next = _following(track);
+        if (next != NONE)
+            _prefetch(next);
+    }
+
+    void Playlist::_free(Track& track)
+    {
+        if (track.chunk != nullptr)
+        {
+            // Mix_FreeChunk() halts the channel if it still plays it.
+            Mix_FreeChunk(track.chunk);
+            track.chunk = nullptr;
+        }
+        track.pcm.reset();
+        track.index = NONE;
+    }
+}
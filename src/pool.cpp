@@ -0,0 +1,95 @@
+/*
+ * SDLX, a SDL graphics library for CS students.
+ * Copyright (C) 2017, Seth Kasmann, Yihsiang Liow
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pool.h"
+
+namespace sdlx {
+
+    ThreadPool::ThreadPool(int threads)
+    : _running(0), _quit(false)
+    {
+        if (threads <= 0)
+        {
+            threads = static_cast<int>(std::thread::hardware_concurrency()) - 1;
+            if (threads < 1)
+                threads = 1;
+        }
+        for (int i = 0; i < threads; ++i)
+            _threads.push_back(std::thread(&ThreadPool::_run, this));
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _quit = true;
+        }
+        _ready.notify_all();
+        for (size_t i = 0; i < _threads.size(); ++i)
+            _threads[i].join();
+    }
+
+    void ThreadPool::submit(const std::function<void()>& job)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _jobs.push_back(job);
+        }
+        _ready.notify_one();
+    }
+
+    void ThreadPool::wait()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        while (!_jobs.empty() || _running > 0)
+            _idle.wait(lock);
+    }
+
+    int ThreadPool::size() const
+    {
+        return _threads.size();
+    }
+
+    //------------------------------------------------------------------------
+    // Private Functions - You cannot call these.
+    //------------------------------------------------------------------------
+
+    void ThreadPool::_run()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        for (;;)
+        {
+            while (_jobs.empty() && !_quit)
+                _ready.wait(lock);
+            if (_jobs.empty())
+                break;
+
+            std::function<void()> job = _jobs.front();
+            _jobs.pop_front();
+            ++_running;
+
+            lock.unlock();
+            job();
+            lock.lock();
+
+            --_running;
+            if (_jobs.empty() && _running == 0)
+                _idle.notify_all();
+        }
+    }
+}
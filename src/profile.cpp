@@ -0,0 +1,253 @@
+/*
+ * SDLX, a SDL graphics library for CS students.
+ * Copyright (C) 2017, Seth Kasmann, Yihsiang Liow
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "profile.h"
+#include "sdllib.h"
+
+namespace sdlx {
+
+    namespace {
+
+        struct ZoneRecord
+        {
+            const char* name;
+            uint64_t begin;
+            uint64_t end;
+            uint32_t frame;
+        };
+
+        // One ring per thread. Only the owning thread writes records and
+        // advances head, so recording needs no lock. When the thread exits
+        // the ring is marked finished and handed to the next new thread.
+        struct ThreadBuffer
+        {
+            uint32_t tid;
+            bool finished;
+            std::atomic<uint64_t> head;
+            ZoneRecord records[PROFILE_CAPACITY];
+        };
+
+        std::mutex registry_mutex;
+        std::vector<std::unique_ptr<ThreadBuffer> > registry;
+        uint32_t next_tid = 0;
+
+        // Releases the ring of the owning thread when the thread exits.
+        struct BufferOwner
+        {
+            ThreadBuffer* buffer = nullptr;
+
+            ~BufferOwner()
+            {
+                if (buffer == nullptr)
+                    return;
+                std::lock_guard<std::mutex> lock(registry_mutex);
+                buffer->finished = true;
+                buffer = nullptr;
+            }
+        };
+
+        thread_local BufferOwner local_buffer;
+
+        std::atomic<uint32_t> frame_index(0);
+        std::atomic<uint64_t> frame_begin(0);
+
+        ThreadBuffer* get_buffer()
+        {
+            if (local_buffer.buffer == nullptr)
+            {
+                std::lock_guard<std::mutex> lock(registry_mutex);
+
+                // Reuse the ring of a thread that has exited so short-lived
+                // threads do not each leave a buffer behind.
+                ThreadBuffer* buffer = nullptr;
+                for (size_t i = 0; i < registry.size() && !buffer; ++i)
+                {
+                    if (registry[i]->finished)
+                        buffer = registry[i].get();
+                }
+                if (buffer == nullptr)
+                {
+                    registry.push_back(std::unique_ptr<ThreadBuffer>(new ThreadBuffer));
+                    buffer = registry.back().get();
+                }
+
+                buffer->tid = ++next_tid;
+                buffer->finished = false;
+                buffer->head.store(0);
+                local_buffer.buffer = buffer;
+            }
+            return local_buffer.buffer;
+        }
+
+        void record(const char* name, uint64_t begin, uint64_t end, uint32_t frame)
+        {
+            ThreadBuffer* buffer = get_buffer();
+            uint64_t head = buffer->head.load(std::memory_order_relaxed);
+            ZoneRecord& r = buffer->records[head & (PROFILE_CAPACITY - 1)];
+            r.name = name;
+            r.begin = begin;
+            r.end = end;
+            r.frame = frame;
+            buffer->head.store(head + 1, std::memory_order_release);
+        }
+
+        // Copies the records of b into out. Only records below the head
+        // snapshot are read, and any the owning thread may have overwritten
+        // while we copied are dropped afterwards.
+        void snapshot(const ThreadBuffer& b, std::vector<ZoneRecord>& out)
+        {
+            out.clear();
+            uint64_t head = b.head.load(std::memory_order_acquire);
+            uint64_t tail = head > PROFILE_CAPACITY ? head - PROFILE_CAPACITY : 0;
+            for (uint64_t j = tail; j < head; ++j)
+                out.push_back(b.records[j & (PROFILE_CAPACITY - 1)]);
+
+            // The writer may be filling slot "now" (which aliases record
+            // now - PROFILE_CAPACITY), so everything at or below that is
+            // suspect.
+            std::atomic_thread_fence(std::memory_order_acquire);
+            uint64_t now = b.head.load(std::memory_order_relaxed);
+            uint64_t safe = now + 1 > PROFILE_CAPACITY ? now + 1 - PROFILE_CAPACITY : 0;
+            if (safe > tail)
+                out.erase(out.begin(), out.begin() + std::min(safe - tail, head - tail));
+        }
+
+        void write_escaped(std::ostream& out, const char* s)
+        {
+            for (; *s; ++s)
+            {
+                if (*s == '"' || *s == '\\')
+                    out << '\\' << *s;
+                else if (static_cast<unsigned char>(*s) >= 0x20)
+                    out << *s;
+            }
+        }
+    }
+
+    //------------------------------------------------------------------------
+    // Zone Class
+    //------------------------------------------------------------------------
+
+    Zone::Zone(const char* name)
+    : _name(name),
+      _begin(SDL_GetPerformanceCounter()),
+      _frame(frame_index.load(std::memory_order_relaxed))
+    {}
+
+    Zone::~Zone()
+    {
+        record(_name, _begin, SDL_GetPerformanceCounter(), _frame);
+    }
+
+    //------------------------------------------------------------------------
+    // Frames
+    //------------------------------------------------------------------------
+
+    uint32_t profile_frame()
+    {
+        // The frame itself is recorded as a zone so it shows up as a bar on
+        // the timeline of the thread that draws.
+        uint64_t now = SDL_GetPerformanceCounter();
+        uint64_t begin = frame_begin.exchange(now);
+        uint32_t frame = frame_index.fetch_add(1);
+        if (begin != 0)
+            record("frame", begin, now, frame);
+        return frame + 1;
+    }
+
+    uint32_t profile_frame_index()
+    {
+        return frame_index.load();
+    }
+
+    //------------------------------------------------------------------------
+    // Chrome trace_event export
+    //------------------------------------------------------------------------
+
+    bool profile_write(const std::string& filename, uint32_t first, uint32_t last)
+    {
+        std::ofstream out(filename.c_str());
+        if (!out)
+        {
+            std::cout << "Error in profile_write(): Cannot open " << filename << '\n';
+            return false;
+        }
+
+        const double us = 1000000.0 / SDL_GetPerformanceFrequency();
+
+        std::vector<uint32_t> tids;
+        std::vector<std::vector<ZoneRecord> > zones;
+        {
+            std::lock_guard<std::mutex> lock(registry_mutex);
+            tids.resize(registry.size());
+            zones.resize(registry.size());
+            for (size_t i = 0; i < registry.size(); ++i)
+            {
+                tids[i] = registry[i]->tid;
+                snapshot(*registry[i], zones[i]);
+            }
+        }
+
+        // Timestamps are written relative to the earliest zone in range so
+        // the numbers stay small.
+        uint64_t base = 0;
+        for (size_t i = 0; i < zones.size(); ++i)
+        {
+            for (size_t j = 0; j < zones[i].size(); ++j)
+            {
+                const ZoneRecord& r = zones[i][j];
+                if (r.frame >= first && r.frame <= last
+                    && (base == 0 || r.begin < base))
+                    base = r.begin;
+            }
+        }
+
+        out << "{\"traceEvents\":[";
+        bool comma = false;
+        for (size_t i = 0; i < zones.size(); ++i)
+        {
+            if (comma) out << ',';
+            out << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+                << tids[i] << ",\"args\":{\"name\":\"thread " << tids[i] << "\"}}";
+            comma = true;
+
+            for (size_t j = 0; j < zones[i].size(); ++j)
+            {
+                const ZoneRecord& r = zones[i][j];
+                if (r.frame < first || r.frame > last)
+                    continue;
+                out << ",\n{\"name\":\"";
+                write_escaped(out, r.name);
+                out << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << tids[i]
+                    << ",\"ts\":" << (r.begin - base) * us
+                    << ",\"dur\":" << (r.end - r.begin) * us
+                    << ",\"args\":{\"frame\":" << r.frame << "}}";
+            }
+        }
+        out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+        return static_cast<bool>(out);
+    }
+}
@@ -0,0 +1,141 @@
+/*
+ * SDLX, a SDL graphics library for CS students.
+ * Copyright (C) 2017, Seth Kasmann, Yihsiang Liow
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <iostream>
+#include "rwops.h"
+#include "sdllib.h"
+
+namespace sdlx {
+
+    namespace {
+
+        struct Range
+        {
+            SDL_RWops* file;
+            int64_t begin;
+            int64_t size;
+            int64_t position;   // from begin
+        };
+
+        Range* range(SDL_RWops* rw)
+        {
+            return static_cast<Range*>(rw->hidden.unknown.data1);
+        }
+
+        Sint64 range_size(SDL_RWops* rw)
+        {
+            return range(rw)->size;
+        }
+
+        Sint64 range_seek(SDL_RWops* rw, Sint64 offset, int whence)
+        {
+            Range* r = range(rw);
+            Sint64 p = offset;
+            if (whence == RW_SEEK_CUR)
+                p += r->position;
+            else if (whence == RW_SEEK_END)
+                p += r->size;
+            if (p < 0 || p > r->size)
+                return SDL_SetError("Seek outside of the range");
+            if (SDL_RWseek(r->file, r->begin + p, RW_SEEK_SET) < 0)
+                return -1;
+            r->position = p;
+            return p;
+        }
+
+        size_t range_read(SDL_RWops* rw, void* buffer, size_t size, size_t count)
+        {
+            Range* r = range(rw);
+            if (size == 0)
+                return 0;
+            const size_t left = static_cast<size_t>(r->size - r->position) / size;
+            const size_t n = SDL_RWread(r->file, buffer, size, count < left ? count : left);
+            r->position += n * size;
+            return n;
+        }
+
+        size_t range_write(SDL_RWops* rw, const void* buffer, size_t size, size_t count)
+        {
+            SDL_SetError("A range is read-only");
+            return 0;
+        }
+
+        int range_close(SDL_RWops* rw)
+        {
+            Range* r = range(rw);
+            const int status = SDL_RWclose(r->file);
+            delete r;
+            SDL_FreeRW(rw);
+            return status;
+        }
+    }
+
+    SDL_RWops* rw_from_span(Span span)
+    {
+        SDL_RWops* rw = SDL_RWFromConstMem(span.data, static_cast<int>(span.size));
+        if (rw == NULL)
+            std::cout << "Error in rw_from_span(): " << SDL_GetError() << '\n';
+        return rw;
+    }
+
+    SDL_RWops* rw_from_range(const char* filename, int64_t offset, int64_t size)
+    {
+        SDL_RWops* file = SDL_RWFromFile(filename, "rb");
+        if (file == NULL)
+        {
+            std::cout << "Error in rw_from_range(): " << SDL_GetError() << '\n';
+            return NULL;
+        }
+        return rw_from_range(file, offset, size);
+    }
+
+    SDL_RWops* rw_from_range(SDL_RWops* file, int64_t offset, int64_t size)
+    {
+        if (file == NULL)
+            return NULL;
+        const Sint64 total = SDL_RWsize(file);
+        if (offset < 0 || size < 0 || (total >= 0 && offset + size > total)
+            || SDL_RWseek(file, offset, RW_SEEK_SET) < 0)
+        {
+            std::cout << "Error in rw_from_range(): " << size << " bytes at "
+                      << offset << " are not inside the file.\n";
+            SDL_RWclose(file);
+            return NULL;
+        }
+
+        SDL_RWops* rw = SDL_AllocRW();
+        if (rw == NULL)
+        {
+            SDL_RWclose(file);
+            return NULL;
+        }
+        Range* r = new Range;
+        r->file = file;
+        r->begin = offset;
+        r->size = size;
+        r->position = 0;
+        rw->size = range_size;
+        rw->seek = range_seek;
+        rw->read = range_read;
+        rw->write = range_write;
+        rw->close = range_close;
+        rw->type = SDL_RWOPS_UNKNOWN;
+        rw->hidden.unknown.data1 = r;
+        return rw;
+    }
+}
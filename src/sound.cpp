@@ -17,8 +17,11 @@
  */
 
 #include <iostream>
+#include <utility>
 #include "sound.h"
+#include "context.h"
 #include "sdllib.h"
+#include "profile.h"
 
 namespace sdlx {
 
@@ -28,25 +31,124 @@ namespace sdlx {
 
     Sound::Sound(const char* filename)
     {
-        _on = true;
+        _open();
+        sample = nullptr;
+        if (filename != nullptr && _audio)
+            _shared = context().audio().pcm().get(filename, context().audio().spec());
+        if (_shared)
+            sample = Mix_QuickLoad_RAW(const_cast<Uint8*>(_shared->data()),
+                                       static_cast<Uint32>(_shared->size()));
+        if (sample == nullptr)
+        {
+            std::cout << "Error in Sound: Cannot load "
+                      << (filename != nullptr ? filename : "(null)") << ".\n"
+                      << Mix_GetError() << std::endl;
+        }
+    }
+
+    Sound::Sound(Span file)
+    {
+        _open();
+        sample = Mix_LoadWAV_RW(SDL_RWFromConstMem(file.data, static_cast<int>(file.size)), 1);
+        if (sample == nullptr)
+        {
+            std::cout << "Error in Sound: Mix_LoadWAV_RW returns NULL.\n"
+                      << Mix_GetError() << std::endl;
+        }
+    }
+
+    Sound::Sound(SDL_RWops* file)
+    {
+        _open();
+        sample = Mix_LoadWAV_RW(file, 1);
+        if (sample == nullptr)
+        {
+            std::cout << "Error in Sound: Mix_LoadWAV_RW returns NULL.\n"
+                      << Mix_GetError() << std::endl;
+        }
+    }
 
-        Mix_OpenAudio(MIX_DEFAULT_FREQUENCY,
-                      MIX_DEFAULT_FORMAT,
-                      MIX_DEFAULT_CHANNELS, 512);
-        sample = Mix_LoadWAV(filename);
+    Sound::Sound(const void* pcm, size_t bytes, int frequency, uint16_t format,
+                 int channels)
+    {
+        _open();
+        sample = nullptr;
+
+        if (!_audio)
+            return;
+
+        const AudioConfig spec = context().audio().spec();
+        const Uint8* samples = static_cast<const Uint8*>(pcm);
+        if (frequency != spec.frequency || format != spec.format
+            || channels != spec.channels)
+        {
+            if (!convert_pcm(pcm, bytes, frequency, format, channels, spec, _pcm))
+                return;
+            samples = _pcm.data();
+            bytes = _pcm.size();
+        }
+
+        // Mix_QuickLoad_RAW does not copy or take ownership of the samples.
+        sample = Mix_QuickLoad_RAW(const_cast<Uint8*>(samples),
+                                   static_cast<Uint32>(bytes));
         if (sample == nullptr)
         {
-            std::cout << "Error in Sound: Mix_LoadWAV returs NULL.\n"
+            std::cout << "Error in Sound: Mix_QuickLoad_RAW returns NULL.\n"
                       << Mix_GetError() << std::endl;
         }
     }
 
+    Sound::Sound(Sound&& other)
+    : sample(other.sample), _on(other._on), _params(other._params),
+      _audio(other._audio), _pcm(std::move(other._pcm)),
+      _shared(std::move(other._shared))
+    {
+        other.sample = nullptr;
+        other._audio = false;
+    }
+
+    Sound& Sound::operator=(Sound&& other)
+    {
+        if (this != &other)
+        {
+            _free();
+            sample = other.sample;
+            _on = other._on;
+            _params = other._params;
+            _audio = other._audio;
+            _pcm = std::move(other._pcm);
+            _shared = std::move(other._shared);
+            other.sample = nullptr;
+            other._audio = false;
+        }
+        return *this;
+    }
+
     Sound::~Sound()
     {
-        Mix_HaltChannel(-1);
-        Mix_CloseAudio();
+        _free();
+    }
+
+    void Sound::_open()
+    {
+        _on = true;
+        _audio = context().audio().acquire();
+    }
+
+    void Sound::_free()
+    {
+        // Only the voices playing this sample are stopped.
+        if (sample != nullptr)
+            context().audio().stop(sample);
         Mix_FreeChunk(sample);
         sample = nullptr;
+        _pcm.clear();
+        _shared.reset();
+        if (_audio)
+        {
+            context().audio().release();
+            _audio = false;
+        }
     }
 
     void Sound::on()
@@ -59,44 +161,135 @@ namespace sdlx {
         _on = false;
     }
 
-    void Sound::play()
+    int Sound::play()
+    {
+        SDLX_ZONE("Sound::play");
+        if (!_on)
+            return -1;
+        return context().audio().play(sample, _params);
+    }
+
+    int Sound::play_at(float x, float y)
+    {
+        SDLX_ZONE("Sound::play_at");
+        if (!_on || sample == nullptr)
+            return -1;
+        return context().audio().spatial().play(sample, _params, x, y);
+    }
+
+    void Sound::set_priority(int priority)
+    {
+        _params.priority = priority;
+    }
+
+    void Sound::set_limit(int limit)
+    {
+        _params.limit = limit;
+    }
+
+    void Sound::set_coalesce(uint32_t ms)
+    {
+        _params.coalesce = ms;
+    }
+
+    void Sound::set_volume(int volume)
     {
-        if (_on)
-            Mix_PlayChannel(-1, sample, 0);
+        _params.volume = volume;
     }
 
     /*************************************************************************
         Class Music
     *************************************************************************/
 
-    Music::Music(const char* filename)
+    namespace {
+
+        // Decoded music plays on the reserved channel.
+        const int MUSIC_CHANNEL = 0;
+    }
+
+    Music::Music(const char* filename, MusicMode mode)
     {
-        _on = true;
-        Mix_OpenAudio(MIX_DEFAULT_FREQUENCY,
-                      MIX_DEFAULT_FORMAT,
-                      MIX_DEFAULT_CHANNELS, 512);
-        sample = Mix_LoadMUS(filename);
-        if (sample == nullptr) 
+        _open();
+        _load(filename, mode);
+    }
+
+    Music::Music(Span file)
+    {
+        _open();
+        sample = Mix_LoadMUS_RW(SDL_RWFromConstMem(file.data, static_cast<int>(file.size)), 1);
+        if (sample == nullptr)
         {
-            std::cout << "Error in Sound: Mix_LoadMUS returns NULL.\n"
+            std::cout << "Error in Sound: Mix_LoadMUS_RW returns NULL.\n"
+                      << Mix_GetError() << std::endl;
+        }
+    }
+
+    Music::Music(SDL_RWops* file)
+    {
+        _open();
+        sample = Mix_LoadMUS_RW(file, 1);
+        if (sample == nullptr)
+        {
+            std::cout << "Error in Sound: Mix_LoadMUS_RW returns NULL.\n"
                       << Mix_GetError() << std::endl;
         }
     }
 
+    Music::Music(Music&& other)
+    : sample(other.sample), _decoded(other._decoded),
+      _pcm(std::move(other._pcm)), _on(other._on), _audio(other._audio)
+    {
+        other.sample = nullptr;
+        other._decoded = nullptr;
+        other._audio = false;
+    }
+
+    Music& Music::operator=(Music&& other)
+    {
+        if (this != &other)
+        {
+            _close();
+            sample = other.sample;
+            _decoded = other._decoded;
+            _pcm = std::move(other._pcm);
+            _on = other._on;
+            _audio = other._audio;
+            other.sample = nullptr;
+            other._decoded = nullptr;
+            other._audio = false;
+        }
+        return *this;
+    }
+
     Music::~Music()
     {
-        Mix_HaltChannel(-1);
-        Mix_CloseAudio();
-        free();
+        _close();
+    }
+
+    void Music::_open()
+    {
         sample = nullptr;
+        _decoded = nullptr;
+        _on = true;
+        _audio = context().audio().acquire();
+    }
+
+    void Music::_close()
+    {
+        free();
+        if (_audio)
+        {
+            context().audio().release();
+            _audio = false;
+        }
     }
 
-    void Music::load(const char* filename)
+    void Music::load(const char* filename, MusicMode mode)
     {
         if (filename != nullptr)
         {
             free();
-            sample = Mix_LoadMUS(filename);
+            _load(filename, mode);
         }
     }
 
@@ -108,6 +301,14 @@ namespace sdlx {
             Mix_FreeMusic(sample);
             sample = nullptr;
         }
+        if (_decoded != nullptr)
+        {
+            if (Mix_GetChunk(MUSIC_CHANNEL) == _decoded)
+                Mix_HaltChannel(MUSIC_CHANNEL);
+            Mix_FreeChunk(_decoded);
+            _decoded = nullptr;
+        }
+        _pcm.reset();
     }
 
     void Music::on()
@@ -118,19 +319,61 @@ namespace sdlx {
 
     void Music::off()
     {
-        Mix_HaltMusic();
+        stop();
         _on = false;
     }
 
     void Music::play()
     {
-        if (_on)
+        if (!_on)
+            return;
+        // Only one music plays at a time, streamed or decoded.
+        if (_decoded != nullptr)
+        {
+            Mix_HaltMusic();
+            Mix_PlayChannel(MUSIC_CHANNEL, _decoded, -1);
+        }
+        else
+        {
+            Mix_HaltChannel(MUSIC_CHANNEL);
             Mix_PlayMusic(sample, -1);
+        }
     }
 
     void Music::stop()
     {
         Mix_HaltMusic();
+        Mix_HaltChannel(MUSIC_CHANNEL);
+    }
+
+    //------------------------------------------------------------------------
+    // Private Functions - You cannot call these.
+    //------------------------------------------------------------------------
+
+    void Music::_load(const char* filename, MusicMode mode)
+    {
+        if (mode == MUSIC_DECODED)
+        {
+            if (filename != nullptr && _audio)
+                _pcm = context().audio().pcm().get(filename, context().audio().spec());
+            if (_pcm)
+                _decoded = Mix_QuickLoad_RAW(const_cast<Uint8*>(_pcm->data()),
+                                             static_cast<Uint32>(_pcm->size()));
+            if (_decoded == nullptr)
+            {
+                std::cout << "Error in Music: Cannot decode "
+                          << (filename != nullptr ? filename : "(null)") << ".\n"
+                          << Mix_GetError() << std::endl;
+            }
+            return;
+        }
+
+        sample = Mix_LoadMUS(filename);
+        if (sample == nullptr)
+        {
+            std::cout << "Error in Sound: Mix_LoadMUS returns NULL.\n"
+                      << Mix_GetError() << std::endl;
+        }
     }
 
 }
\ No newline at end of file
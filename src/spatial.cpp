@@ -0,0 +1,285 @@
+/*
+ * SDLX, a SDL graphics library for CS students.
+ * Copyright (C) 2017, Seth Kasmann, Yihsiang Liow
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include "audio.h"
+#include "spatial.h"
+#include "sdllib.h"
+#include "profile.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SDLX_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace sdlx {
+
+    namespace {
+
+        const size_t EMITTERS = MIXER_VOICES;
+
+        // What a gain and pan become for each mixer.
+        int native_volume(int volume, float gain)
+        {
+            return static_cast<int>(volume * gain + 0.5f);
+        }
+
+        int native_pan(float pan)
+        {
+            return static_cast<int>(pan * 64.0f);
+        }
+
+        void mixer_levels(float gain, float pan, uint8_t& left, uint8_t& right,
+                          uint8_t& distance)
+        {
+            left = static_cast<uint8_t>(255.0f * std::min(1.0f, 1.0f - pan));
+            right = static_cast<uint8_t>(255.0f * std::min(1.0f, 1.0f + pan));
+            distance = static_cast<uint8_t>(255.0f * (1.0f - gain));
+        }
+    }
+
+    Spatial::Spatial(AudioDevice& device)
+    : _device(device), _listener_x(0.0f), _listener_y(0.0f), _full(100.0f),
+      _silent(1000.0f)
+    {
+        _emitters.reserve(EMITTERS);
+        _x.reserve(EMITTERS);
+        _y.reserve(EMITTERS);
+        _gain.reserve(EMITTERS);
+        _pan.reserve(EMITTERS);
+    }
+
+    void Spatial::set_listener(float x, float y)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _listener_x = x;
+        _listener_y = y;
+    }
+
+    void Spatial::set_range(float full, float silent)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _full = std::max(full, 0.0f);
+        _silent = std::max(silent, _full + 1.0f);
+    }
+
+    int Spatial::play(Mix_Chunk* chunk, const VoiceParams& params, float x, float y)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        // The voice starts with its gain and pan already in place, so the
+        // first buffer is not mixed at full volume in the centre.
+        float gain, pan;
+        _level(x, y, gain, pan);
+
+        Emitter e;
+        e.chunk = chunk;
+        e.volume = params.volume;
+        e.native = _device.native().is_open();
+        e.native_volume = native_volume(params.volume, gain);
+        e.native_pan = native_pan(pan);
+        mixer_levels(gain, pan, e.left, e.right, e.distance);
+        if (e.native)
+        {
+            VoiceParams placed = params;
+            placed.volume = e.native_volume;
+            e.voice = _device.native().play(chunk, placed, e.native_pan / 64.0f);
+        }
+        else
+            e.voice = _device.voices().play(chunk, params, _place, &e);
+        if (e.voice < 0)
+            return -1;
+        const int voice = e.voice;
+
+        // A voice that was stolen or restarted is replaced.
+        for (size_t i = 0; i < _emitters.size(); ++i)
+        {
+            if (_emitters[i].voice == voice)
+            {
+                _remove(i);
+                break;
+            }
+        }
+
+        _emitters.push_back(e);
+        _x.push_back(x);
+        _y.push_back(y);
+        _gain.push_back(gain);
+        _pan.push_back(pan);
+        return voice;
+    }
+
+    void Spatial::move(int voice, float x, float y)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (size_t i = 0; i < _emitters.size(); ++i)
+        {
+            if (_emitters[i].voice == voice)
+            {
+                _x[i] = x;
+                _y[i] = y;
+                return;
+            }
+        }
+    }
+
+    void Spatial::update()
+    {
+        SDLX_ZONE("Spatial::update");
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (size_t i = 0; i < _emitters.size();)
+        {
+            if (_playing(_emitters[i]))
+                ++i;
+            else
+                _remove(i);
+        }
+        _compute(0, _emitters.size());
+        for (size_t i = 0; i < _emitters.size(); ++i)
+            _apply(i);
+    }
+
+    int Spatial::size() const
+    {
+        return _emitters.size();
+    }
+
+    void Spatial::clear()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _emitters.clear();
+        _x.clear();
+        _y.clear();
+        _gain.clear();
+        _pan.clear();
+    }
+
+    //------------------------------------------------------------------------
+    // Private Functions - You cannot call these.
+    //------------------------------------------------------------------------
+
+    bool Spatial::_playing(const Emitter& e) const
+    {
+        if (e.native)
+            return _device.native().playing(e.voice);
+        return Mix_Playing(e.voice) && Mix_GetChunk(e.voice) == e.chunk;
+    }
+
+    // Order does not matter, so the last one takes its place.
+    void Spatial::_remove(size_t i)
+    {
+        const size_t last = _emitters.size() - 1;
+        _emitters[i] = _emitters[last];
+        _x[i] = _x[last];
+        _y[i] = _y[last];
+        _gain[i] = _gain[last];
+        _pan[i] = _pan[last];
+        _emitters.pop_back();
+        _x.pop_back();
+        _y.pop_back();
+        _gain.pop_back();
+        _pan.pop_back();
+    }
+
+    // Gain and pan of emitters [begin, end), four at a time where possible.
+    void Spatial::_compute(size_t begin, size_t end)
+    {
+        size_t i = begin;
+#ifdef SDLX_SSE2
+        const float scale = 1.0f / (_silent - _full);
+        const __m128 lx = _mm_set1_ps(_listener_x);
+        const __m128 ly = _mm_set1_ps(_listener_y);
+        const __m128 full = _mm_set1_ps(_full);
+        const __m128 silent = _mm_set1_ps(_silent);
+        const __m128 s = _mm_set1_ps(scale);
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 tiny = _mm_set1_ps(1e-6f);
+        for (; i + 4 <= end; i += 4)
+        {
+            const __m128 dx = _mm_sub_ps(_mm_loadu_ps(&_x[i]), lx);
+            const __m128 dy = _mm_sub_ps(_mm_loadu_ps(&_y[i]), ly);
+            const __m128 d = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)));
+            const __m128 g = _mm_mul_ps(_mm_sub_ps(silent, d), s);
+            _mm_storeu_ps(&_gain[i], _mm_min_ps(one, _mm_max_ps(zero, g)));
+            const __m128 r = _mm_max_ps(_mm_max_ps(d, full), tiny);
+            _mm_storeu_ps(&_pan[i], _mm_div_ps(dx, r));
+        }
+#endif
+        for (; i < end; ++i)
+            _level(_x[i], _y[i], _gain[i], _pan[i]);
+    }
+
+    // The same for a single position.
+    void Spatial::_level(float x, float y, float& gain, float& pan) const
+    {
+        const float dx = x - _listener_x;
+        const float dy = y - _listener_y;
+        const float d = std::sqrt(dx * dx + dy * dy);
+        gain = std::min(1.0f, std::max(0.0f, (_silent - d) * (1.0f / (_silent - _full))));
+        pan = dx / std::max(std::max(d, _full), 1e-6f);
+    }
+
+    // Sends an emitter's gain and pan to its mixer if they changed enough
+    // to be heard.
+    void Spatial::_apply(size_t i)
+    {
+        Emitter& e = _emitters[i];
+
+        if (e.native)
+        {
+            const int volume = native_volume(e.volume, _gain[i]);
+            const int p = native_pan(_pan[i]);
+            if (volume != e.native_volume)
+            {
+                _device.native().set_volume(e.voice, volume);
+                e.native_volume = volume;
+            }
+            if (p != e.native_pan)
+            {
+                _device.native().set_pan(e.voice, p / 64.0f);
+                e.native_pan = p;
+            }
+            return;
+        }
+
+        uint8_t left, right, distance;
+        mixer_levels(_gain[i], _pan[i], left, right, distance);
+        if (left != e.left || right != e.right)
+        {
+            Mix_SetPanning(e.voice, left, right);
+            e.left = left;
+            e.right = right;
+        }
+        if (distance != e.distance)
+        {
+            Mix_SetDistance(e.voice, distance);
+            e.distance = distance;
+        }
+    }
+
+    // Sets up a new SDL_mixer voice while the pool keeps the audio thread
+    // out.
+    void Spatial::_place(int channel, void* emitter)
+    {
+        const Emitter* e = static_cast<const Emitter*>(emitter);
+        Mix_SetPanning(channel, e->left, e->right);
+        Mix_SetDistance(channel, e->distance);
+    }
+}
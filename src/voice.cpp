@@ -0,0 +1,236 @@
+/*
+ * SDLX, a SDL graphics library for CS students.
+ * Copyright (C) 2017, Seth Kasmann, Yihsiang Liow
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include "voice.h"
+#include "sdllib.h"
+
+namespace sdlx {
+
+    VoiceParams::VoiceParams()
+    : priority(0), limit(4), coalesce(10), volume(MIX_MAX_VOLUME)
+    {}
+
+    VoicePool::VoicePool()
+    : _reserved(0), _steal(STEAL_OLDEST), _effect(NULL), _effect_data(NULL),
+      _stolen(0), _refused(0), _coalesced(0)
+    {}
+
+    void VoicePool::resize(int voices, int reserved)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        const int channels = Mix_AllocateChannels(voices > 0 ? voices + reserved : 0);
+        _reserved = Mix_ReserveChannels(std::min(reserved, channels));
+        const Voice none = { NULL, 0, 0, 0 };
+        _voices.assign(channels, none);
+    }
+
+    int VoicePool::size() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _voices.size() - _reserved;
+    }
+
+    void VoicePool::set_steal(Steal steal)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _steal = steal;
+    }
+
+    void VoicePool::set_effect(VoiceEffect effect, void* data)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _effect = effect;
+        _effect_data = data;
+    }
+
+    int VoicePool::play(Mix_Chunk* chunk, const VoiceParams& params,
+                        VoiceSetup setup, void* data)
+    {
+        if (chunk == NULL)
+            return -1;
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        const uint32_t now = SDL_GetTicks();
+
+        std::unordered_map<Mix_Chunk*, uint32_t>::iterator last = _last.find(chunk);
+        if (last != _last.end() && now - last->second < params.coalesce)
+        {
+            ++_coalesced;
+            return -1;
+        }
+
+        int channel = _choose(chunk, params);
+        if (channel < 0)
+        {
+            ++_refused;
+            return -1;
+        }
+        // The audio thread is kept out until the voice is set up, so its
+        // first buffer is mixed with the effect and the setup in place.
+        Mix_LockAudio();
+        if (_busy(channel))
+        {
+            Mix_HaltChannel(channel);
+            ++_stolen;
+        }
+
+        Mix_Volume(channel, params.volume);
+        if (Mix_PlayChannel(channel, chunk, 0) < 0)
+        {
+            Mix_UnlockAudio();
+            ++_refused;
+            return -1;
+        }
+        // SDL_mixer drops a channel's effects when it stops playing.
+        if (_effect != NULL)
+            Mix_RegisterEffect(channel, _effect, NULL, _effect_data);
+        if (setup != NULL)
+            setup(channel, data);
+        Mix_UnlockAudio();
+        Voice& v = _voices[channel];
+        v.chunk = chunk;
+        v.priority = params.priority;
+        v.volume = params.volume;
+        v.start = now;
+        _last[chunk] = now;
+        return channel;
+    }
+
+    void VoicePool::stop(Mix_Chunk* chunk)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (size_t i = _reserved; i < _voices.size(); ++i)
+        {
+            if (_voices[i].chunk == chunk)
+            {
+                if (_busy(i))
+                    Mix_HaltChannel(i);
+                _voices[i].chunk = NULL;
+            }
+        }
+        // The address may be reused by the next sample that is loaded.
+        _last.erase(chunk);
+    }
+
+    int VoicePool::active() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        int n = 0;
+        for (size_t i = _reserved; i < _voices.size(); ++i)
+            n += _busy(i);
+        return n;
+    }
+
+    int VoicePool::playing(Mix_Chunk* chunk) const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        int n = 0;
+        for (size_t i = _reserved; i < _voices.size(); ++i)
+            n += _busy(i) && _voices[i].chunk == chunk;
+        return n;
+    }
+
+    uint32_t VoicePool::stolen() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _stolen;
+    }
+
+    uint32_t VoicePool::refused() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _refused;
+    }
+
+    uint32_t VoicePool::coalesced() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _coalesced;
+    }
+
+    //------------------------------------------------------------------------
+    // Private Functions - You cannot call these.
+    //------------------------------------------------------------------------
+
+    // A voice is busy while its channel plays. A channel playing a chunk the
+    // pool did not start (see Playlist) is busy too.
+    bool VoicePool::_busy(int channel) const
+    {
+        return Mix_Playing(channel) != 0;
+    }
+
+    int VoicePool::_choose(Mix_Chunk* chunk, const VoiceParams& params)
+    {
+        const int n = _voices.size();
+
+        // Too many of this sample: restart its oldest voice.
+        if (params.limit > 0)
+        {
+            int count = 0, oldest = -1;
+            for (int i = _reserved; i < n; ++i)
+            {
+                if (_voices[i].chunk != chunk || !_busy(i))
+                    continue;
+                ++count;
+                if (oldest < 0 || int32_t(_voices[i].start - _voices[oldest].start) < 0)
+                    oldest = i;
+            }
+            if (count >= params.limit)
+                return oldest;
+        }
+
+        for (int i = _reserved; i < n; ++i)
+            if (!_busy(i))
+                return i;
+
+        if (_steal == STEAL_NONE)
+            return -1;
+
+        // Lowest priority first, then the oldest or the quietest.
+        int best = -1;
+        int best_loudness = 0;
+        for (int i = _reserved; i < n; ++i)
+        {
+            const Voice& v = _voices[i];
+            if (v.chunk == NULL || Mix_GetChunk(i) != v.chunk
+                || v.priority > params.priority)
+                continue;
+            const int loudness = v.volume * v.chunk->volume;
+            if (best >= 0)
+            {
+                const Voice& b = _voices[best];
+                if (v.priority != b.priority)
+                {
+                    if (v.priority > b.priority)
+                        continue;
+                }
+                else if (_steal == STEAL_QUIETEST && loudness != best_loudness)
+                {
+                    if (loudness > best_loudness)
+                        continue;
+                }
+                else if (int32_t(v.start - b.start) >= 0)
+                    continue;
+            }
+            best = i;
+            best_loudness = loudness;
+        }
+        return best;
+    }
+}
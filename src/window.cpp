@@ -17,33 +17,95 @@
  */
 
 #include <iostream>
+#include <utility>
 #include <vector>
 #include "window.h"
+#include "context.h"
 #include "image.h"
+#include "hud.h"
+#include "capture.h"
 #include "sdllib.h"
+#include "profile.h"
 
 namespace sdlx {
     
     Window::Window(const std::string& name)
-    : _renderer(nullptr), _window(nullptr)
+    : _window(nullptr), _renderer(nullptr), _surface(nullptr), _hud(nullptr),
+      _capture(nullptr), _hud_on(false), _last_draw(0)
     {
         _init(name, DEFAULT_WIDTH, DEFAULT_HEIGHT);
     }
 
     Window::Window(int width, int height, const std::string& name)
-    : _renderer(nullptr), _window(nullptr)
+    : _window(nullptr), _renderer(nullptr), _surface(nullptr), _hud(nullptr),
+      _capture(nullptr), _hud_on(false), _last_draw(0)
     {
         _init(name, width, height);    
     }
 
+    Window::Window(int width, int height, Offscreen)
+    : _window(nullptr), _renderer(nullptr), _surface(nullptr), _hud(nullptr),
+      _capture(nullptr), _hud_on(false), _last_draw(0)
+    {
+        _init_offscreen(width, height);
+    }
+
     Window::~Window()
     {
-        SDL_DestroyRenderer(_renderer);
-        SDL_DestroyWindow(_window);
+        _destroy();
+    }
+
+    Window::Window(Window&& other)
+    : _window(nullptr), _renderer(nullptr), _surface(nullptr), _hud(nullptr),
+      _capture(nullptr), _hud_on(false), _last_draw(0)
+    {
+        *this = std::move(other);
+    }
+
+    Window& Window::operator=(Window&& other)
+    {
+        if (this != &other)
+        {
+            _destroy();
+            _window = other._window;
+            _renderer = other._renderer;
+            _surface = other._surface;
+            _hud = other._hud;
+            _capture = other._capture;
+            _hud_on = other._hud_on;
+            _last_draw = other._last_draw;
+            _stats = other._stats;
+            _last_stats = other._last_stats;
+            other._window = nullptr;
+            other._renderer = nullptr;
+            other._surface = nullptr;
+            other._hud = nullptr;
+            other._capture = nullptr;
+            other._hud_on = false;
+        }
+        return *this;
+    }
+
+    void Window::_destroy()
+    {
+        // The capture thread is finished before the renderer goes away.
+        delete _capture;
+        delete _hud;
+        if (_renderer != nullptr)
+            SDL_DestroyRenderer(_renderer);
+        if (_window != nullptr)
+            SDL_DestroyWindow(_window);
+        SDL_FreeSurface(_surface);
+        _capture = nullptr;
+        _hud = nullptr;
+        _renderer = nullptr;
+        _window = nullptr;
+        _surface = nullptr;
     }
 
     void Window::_init(const std::string& name, int width, int height)
     {
+        context().require(INIT_VIDEO | INIT_EVENTS);
         _window = SDL_CreateWindow(
             name.c_str(),
             SDL_WINDOWPOS_UNDEFINED,
@@ -57,6 +119,11 @@ namespace sdlx {
 
         _renderer = SDL_CreateRenderer(_window, -1, SDL_RENDERER_ACCELERATED);
 
+        // There is no accelerated renderer without a GPU, e.g. when running
+        // with SDL_VIDEODRIVER=dummy. Fall back to the software renderer.
+        if (_renderer == nullptr)
+            _renderer = SDL_CreateRenderer(_window, -1, SDL_RENDERER_SOFTWARE);
+
         if (_renderer == nullptr)
             std::cout << "Could not create window:" << SDL_GetError() << '\n';
 
@@ -64,38 +131,101 @@ namespace sdlx {
         draw();
     }
 
+    void Window::_init_offscreen(int width, int height)
+    {
+        // No display is needed, only the event queue.
+        context().require(INIT_EVENTS);
+        _surface = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32,
+                                                  SDL_PIXELFORMAT_ARGB8888);
+
+        if (_surface == nullptr)
+        {
+            std::cout << "Could not create offscreen window:" << SDL_GetError() << '\n';
+            return;
+        }
+
+        _renderer = SDL_CreateSoftwareRenderer(_surface);
+
+        if (_renderer == nullptr)
+            std::cout << "Could not create offscreen window:" << SDL_GetError() << '\n';
+
+        clear(BLACK);
+        draw();
+    }
+
     SDL_Renderer* Window::get_renderer()
     {
         return _renderer;
     }
 
+    //------------------------------------------------------------------------
+    // Offscreen pixels
+    //------------------------------------------------------------------------
+
+    bool Window::offscreen() const
+    {
+        return _surface != nullptr;
+    }
+
+    SDL_Surface* Window::get_surface()
+    {
+        return _surface;
+    }
+
+    void* Window::get_pixels()
+    {
+        return _surface != nullptr ? _surface->pixels : nullptr;
+    }
+
+    int Window::get_pitch() const
+    {
+        return _surface != nullptr ? _surface->pitch : 0;
+    }
+
+    //------------------------------------------------------------------------
+    // Window properties
+    //------------------------------------------------------------------------
+
     int Window::get_id() const
     {
-        return SDL_GetWindowID(_window);
+        return _window != nullptr ? SDL_GetWindowID(_window) : 0;
     }
 
     void Window::get_size(int& w, int& h) const
     {
-        SDL_GetWindowSize(_window, &w, &h);
+        if (_surface != nullptr)
+        {
+            w = _surface->w;
+            h = _surface->h;
+        }
+        else
+        {
+            SDL_GetWindowSize(_window, &w, &h);
+        }
     }
 
     void Window::set_size(int w, int h)
     {
-        SDL_SetWindowSize(_window, w, h);
+        if (_window != nullptr)
+            SDL_SetWindowSize(_window, w, h);
     }
 
     void Window::hide()
     {
-        SDL_HideWindow(_window);
+        if (_window != nullptr)
+            SDL_HideWindow(_window);
     }
 
     void Window::show()
     {
-        SDL_ShowWindow(_window);
+        if (_window != nullptr)
+            SDL_ShowWindow(_window);
     }
 
     int Window::fullscreen()
     {
+        if (_window == nullptr)
+            return -1;
         return SDL_SetWindowFullscreen(_window, SDL_WINDOW_FULLSCREEN);
     }
 
@@ -106,11 +236,78 @@ namespace sdlx {
     {
         _set_color(c.r, c.g, c.b, c.a);
         SDL_RenderClear(_renderer);
+        _tally(0);
     }
 
     void Window::draw()
     {
+        SDLX_ZONE("Window::draw");
+
+        uint64_t now = SDL_GetPerformanceCounter();
+        if (_hud != nullptr && _last_draw != 0)
+            _hud->push((now - _last_draw) * 1000.0 / SDL_GetPerformanceFrequency());
+        _last_draw = now;
+
+        if (_capture != nullptr)
+            _capture->service(_renderer);
+
+        if (_hud_on)
+            _hud->render(_renderer, _stats);
+
+        // For an offscreen window this only finishes any queued drawing;
+        // there is nothing to show and no vsync to wait for.
         SDL_RenderPresent(_renderer);
+        _last_stats = _stats;
+        _stats = RenderStats();
+        SDLX_FRAME();
+    }
+
+    //------------------------------------------------------------------------
+    // Performance overlay
+    //------------------------------------------------------------------------
+
+    void Window::show_hud(bool on)
+    {
+        if (on && _hud == nullptr)
+            _hud = new Hud;
+        _hud_on = on;
+    }
+
+    void Window::toggle_hud()
+    {
+        show_hud(!_hud_on);
+    }
+
+    bool Window::hud_visible() const
+    {
+        return _hud_on;
+    }
+
+    const RenderStats& Window::get_stats() const
+    {
+        return _last_stats;
+    }
+
+    //------------------------------------------------------------------------
+    // Frame capture
+    //------------------------------------------------------------------------
+
+    void Window::capture_async(const std::string& filename)
+    {
+        if (_capture == nullptr)
+            _capture = new Capture;
+        _capture->request(filename);
+    }
+
+    void Window::capture_flush()
+    {
+        if (_capture != nullptr)
+            _capture->flush();
+    }
+
+    uint32_t Window::captures_dropped() const
+    {
+        return _capture != nullptr ? _capture->dropped() : 0;
     }
 
     //------------------------------------------------------------------------
@@ -167,6 +364,7 @@ namespace sdlx {
 
     int Window::put_circle(int x, int y, int rad, int r, int g, int b, int a)
     {
+        _tally(1);
         return filledCircleRGBA(_renderer, x, y, rad, r, g, b, a);
     }
 
@@ -187,6 +385,7 @@ namespace sdlx {
 
     int Window::put_unfilled_circle(int x, int y, int rad, int r, int g, int b, int a)
     {
+        _tally(1);
         return circleRGBA(_renderer, x, y, rad, r, g, b, a);
     }
 
@@ -211,6 +410,7 @@ namespace sdlx {
 
     int Window::put_ellipse(int x, int y, int rx, int ry, int r, int g, int b, int a)
     {
+        _tally(1);
         return filledEllipseRGBA(_renderer, x, y, rx, ry, r, g, b, a);
     }
 
@@ -231,6 +431,7 @@ namespace sdlx {
 
     int Window::put_unfilled_ellipse(int x, int y, int rx, int ry, int r, int g, int b, int a)
     {
+        _tally(1);
         return ellipseRGBA(_renderer, x, y, rx, ry, r, g, b, a);
     }
 
@@ -254,11 +455,13 @@ namespace sdlx {
     //------------------------------------------------------------------------
     void Window::put_image(Image& image, Rect& src, Rect& dst)
     {
-        SDL_RenderCopy(_renderer, image.get_texture(), &src, &dst);    
+        _tally(1);
+        SDL_RenderCopy(_renderer, image.get_texture(), &src, &dst);
     }
 
     void Window::put_image(Image& image, Rect& dst)
     {
+        _tally(1);
         SDL_RenderCopy(_renderer, image.get_texture(), NULL, &dst);
     }
 
@@ -336,6 +539,7 @@ namespace sdlx {
             y[i] = p[i].y;
         }
 
+        _tally(1);
         return filledPolygonRGBA(_renderer, x.data(), y.data(), size,
             r, g, b, a); 
     }
@@ -349,6 +553,12 @@ namespace sdlx {
     // Private Functions - You cannot call these.
     //------------------------------------------------------------------------
 
+    void Window::_tally(int primitives)
+    {
+        ++_stats.draw_calls;
+        _stats.primitives += primitives;
+    }
+
     int Window::_set_color(int r, int g, int b, int a)
     {
         return SDL_SetRenderDrawColor(_renderer, r, g, b, a);
@@ -357,6 +567,7 @@ namespace sdlx {
     int Window::_put_point(int x, int y)
     {
         const SDL_Point point = { x, y };
+        _tally(1);
         return SDL_RenderDrawPoints(_renderer, &point, 1);
     }
 
@@ -367,6 +578,7 @@ namespace sdlx {
         points[0].y = y0;
         points[1].x = x1;
         points[1].y = y1;
+        _tally(1);
         return SDL_RenderDrawLines(_renderer, points, 2);
     }
 
@@ -374,11 +586,13 @@ namespace sdlx {
     {
         if (size < 2)
             return -1;
+        _tally(size - 1);
         return SDL_RenderDrawLines(_renderer, p, size);
     }
 
     int Window::_put_rect(const Rect& r)
     {
+        _tally(1);
         return SDL_RenderFillRects(_renderer, &r, 1);
     }
 
@@ -395,6 +609,7 @@ namespace sdlx {
         points[3].y = y + h - 1;
         points[4].x = x;
         points[4].y = y;
+        _tally(1);
         return SDL_RenderDrawLines(_renderer, points, 5);
     }
 
@@ -402,6 +617,7 @@ namespace sdlx {
     {
         if (size < 3)
             return -1;
+        _tally(size - 1);
         return SDL_RenderDrawLines(_renderer, p, size)
              | _put_line(p[size-1].x, p[size-1].y, p[0].x, p[0].y);
     }
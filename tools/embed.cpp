@@ -0,0 +1,174 @@
+/*
+ * SDLX, a SDL graphics library for CS students.
+ * Copyright (C) 2017, Seth Kasmann, Yihsiang Liow
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*****************************************************************************
+
+    sdlxembed - turns files into a header that compiles them into the program
+
+    USAGE:
+        sdlxembed [--namespace NAME] OUTPUT.h FILE...
+
+        make embed
+
+    For every FILE the header has a byte array and an sdlx::Span named
+    after the path of the file, with every character that cannot be part
+    of a name replaced by '_':
+
+        fonts/FreeSans.ttf  ->  assets::fonts_FreeSans_ttf
+
+    and a table of all of them, so they can also be found by path:
+
+        for (int i = 0; i < assets::COUNT; ++i)
+            if (std::strcmp(assets::FILES[i].name, "sounds/laser.wav") == 0)
+                ...
+
+    The Spans can be given to the memory constructors of Image, Font, Sound
+    and Music. Nothing is read from the disk: the data is part of the
+    executable. The arrays are static, so include the header in only one
+    source file.
+
+    Keep this for small files (UI fonts, icons, short sounds) since every
+    byte makes the executable bigger.
+
+*****************************************************************************/
+
+#include <cctype>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "mapped.h"
+
+using namespace sdlx;
+
+namespace {
+
+    std::string identifier(const std::string& path)
+    {
+        std::string s;
+        for (size_t i = 0; i < path.size(); ++i)
+        {
+            unsigned char c = path[i];
+            s += std::isalnum(c) ? static_cast<char>(c) : '_';
+        }
+        if (s.empty() || std::isdigit(static_cast<unsigned char>(s[0])))
+            s = "_" + s;
+        return s;
+    }
+
+    std::string guard(const std::string& path)
+    {
+        std::string s = path;
+        size_t slash = s.find_last_of("/\\");
+        if (slash != std::string::npos)
+            s = s.substr(slash + 1);
+        s = identifier(s);
+        for (size_t i = 0; i < s.size(); ++i)
+            s[i] = std::toupper(static_cast<unsigned char>(s[i]));
+        return s;
+    }
+
+    bool embed(FILE* out, const std::string& path, const std::string& name)
+    {
+        MappedFile file(path);
+        if (!file.is_open())
+            return false;
+
+        std::fprintf(out, "    static const unsigned char %s_data[] = {", name.c_str());
+        const uint8_t* p = file.data();
+        for (size_t i = 0; i < file.size(); ++i)
+        {
+            if (i % 16 == 0)
+                std::fputs("\n        ", out);
+            std::fprintf(out, "0x%02x,", p[i]);
+        }
+        std::fprintf(out, "\n    };\n");
+        std::fprintf(out, "    static const sdlx::Span %s = { %s_data, sizeof(%s_data) };\n\n",
+                     name.c_str(), name.c_str(), name.c_str());
+        return true;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::string ns = "assets";
+    std::string output;
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--namespace" && i + 1 < argc)
+            ns = argv[++i];
+        else if (output.empty())
+            output = arg;
+        else
+            files.push_back(arg);
+    }
+    if (output.empty() || files.empty())
+    {
+        std::cout << "usage: sdlxembed [--namespace NAME] OUTPUT.h FILE...\n";
+        return 2;
+    }
+
+    FILE* out = std::fopen(output.c_str(), "w");
+    if (out == NULL)
+    {
+        std::cout << "Error: Cannot write " << output << '\n';
+        return 1;
+    }
+
+    const std::string g = guard(output);
+    std::fprintf(out, "// Generated by sdlxembed. Do not edit.\n\n");
+    std::fprintf(out, "#ifndef %s\n#define %s\n\n", g.c_str(), g.c_str());
+    std::fprintf(out, "#include \"types.h\"\n\n");
+    std::fprintf(out, "namespace %s {\n\n", ns.c_str());
+
+    int status = 0;
+    std::vector<std::string> names;
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+        const std::string name = identifier(files[i]);
+        if (embed(out, files[i], name))
+            names.push_back(name);
+        else
+        {
+            files.erase(files.begin() + i--);
+            status = 1;
+        }
+    }
+
+    std::fprintf(out, "    struct File\n    {\n        const char* name;\n"
+                      "        sdlx::Span span;\n    };\n\n");
+    std::fprintf(out, "    static const int COUNT = %u;\n\n",
+                 static_cast<unsigned>(names.size()));
+    std::fprintf(out, "    static const File FILES[] = {\n");
+    for (size_t i = 0; i < names.size(); ++i)
+        std::fprintf(out, "        { \"%s\", { %s_data, sizeof(%s_data) } },\n",
+                     files[i].c_str(), names[i].c_str(), names[i].c_str());
+    if (names.empty())
+        std::fprintf(out, "        { 0, { 0, 0 } }\n");
+    std::fprintf(out, "    };\n}\n\n#endif\n");
+
+    if (std::fclose(out) != 0)
+    {
+        std::cout << "Error: Cannot write " << output << '\n';
+        status = 1;
+    }
+    std::cout << output << ": " << names.size() << " files\n";
+    return status;
+}
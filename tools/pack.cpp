@@ -0,0 +1,660 @@
+/*
+ * SDLX, a SDL graphics library for CS students.
+ * Copyright (C) 2017, Seth Kasmann, Yihsiang Liow
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*****************************************************************************
+
+    sdlxpack - builds an asset pack (see includes/pack.h)
+
+    USAGE:
+        sdlxpack [options] OUTPUT DIRECTORY...
+
+        make pack
+
+    Every file under the directories is added to the pack under its path,
+    e.g. "images/galaxian/GalaxianFlagship.gif":
+
+        .bmp .gif .jpg .jpeg .png .tga .tif .tiff
+                      decoded and converted to the texture format
+        .ttf .otf     copied as is
+        .wav          decoded and converted to the audio format
+        anything else copied as is (e.g. music, which is streamed)
+
+    Images no larger than --atlas-max in both directions are packed into
+    atlas pages of --atlas pixels wide.
+
+    Options:
+        --format F       texture format, argb8888 (default) or abgr8888
+        --rate N         audio frequency, default 44100
+        --channels N     audio channels, default 2
+        --atlas N        atlas page width, default 1024. 0 for no atlas.
+        --atlas-max N    largest image put in an atlas, default 256
+        --force          rebuild everything
+
+    The build is incremental. Each asset is stored with the hash of its
+    source file. Assets whose source and options have not changed since
+    OUTPUT was last built are copied from OUTPUT instead of being decoded
+    again, and OUTPUT is not rewritten at all if nothing changed.
+
+*****************************************************************************/
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "files.h"
+#include "mapped.h"
+#include "pack.h"
+#include "sdllib.h"
+
+using namespace sdlx;
+
+namespace {
+
+    struct Options
+    {
+        Options()
+            : format(SDL_PIXELFORMAT_ARGB8888), rate(44100), channels(2),
+              atlas(1024), atlas_max(256), force(false)
+        {}
+        uint32_t format;
+        int rate;
+        int channels;
+        int atlas;
+        int atlas_max;
+        bool force;
+        std::string output;
+        std::vector<std::string> dirs;
+    };
+
+    // One entry of the pack being built. The payload is either owned
+    // (bytes) or borrowed from a mapped file (data).
+    struct Asset
+    {
+        Asset()
+            : data(NULL), size(0)
+        {
+            std::memset(&entry, 0, sizeof(entry));
+            entry.atlas = PACK_NONE;
+        }
+        PackEntry entry;
+        std::vector<uint8_t> bytes;
+        const uint8_t* data;
+        size_t size;
+
+        const uint8_t* payload() const
+        {
+            return bytes.empty() ? data : bytes.data();
+        }
+        size_t payload_size() const
+        {
+            return bytes.empty() ? size : bytes.size();
+        }
+    };
+
+    struct Counts
+    {
+        Counts()
+            : decoded(0), reused(0), copied(0)
+        {}
+        int decoded;
+        int reused;
+        int copied;
+    };
+
+    uint32_t fnv1a(const uint8_t* p, size_t n, uint32_t h=2166136261u)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            h ^= p[i];
+            h *= 16777619u;
+        }
+        return h;
+    }
+
+    uint32_t fnv1a(uint32_t value, uint32_t h)
+    {
+        return fnv1a(reinterpret_cast<const uint8_t*>(&value), sizeof(value), h);
+    }
+
+    std::string extension(const std::string& path)
+    {
+        size_t dot = path.rfind('.');
+        size_t slash = path.rfind('/');
+        if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+            return "";
+        std::string ext = path.substr(dot + 1);
+        for (size_t i = 0; i < ext.size(); ++i)
+            ext[i] = std::tolower(static_cast<unsigned char>(ext[i]));
+        return ext;
+    }
+
+    uint32_t classify(const std::string& path)
+    {
+        const std::string ext = extension(path);
+        if (ext == "bmp" || ext == "gif" || ext == "jpg" || ext == "jpeg"
+            || ext == "png" || ext == "tga" || ext == "tif" || ext == "tiff")
+            return PACK_IMAGE;
+        if (ext == "ttf" || ext == "otf")
+            return PACK_FONT;
+        if (ext == "wav")
+            return PACK_SOUND;
+        return PACK_FILE;
+    }
+
+    //------------------------------------------------------------------------
+    // The pack built last time
+    //------------------------------------------------------------------------
+
+    class OldPack
+    {
+    public:
+        OldPack(const std::string& filename)
+            : _header(NULL)
+        {
+            // A missing pack is the normal case for a first build, so the
+            // file is checked before MappedFile complains about it.
+            FILE* f = std::fopen(filename.c_str(), "rb");
+            if (f == NULL)
+                return;
+            std::fclose(f);
+            if (!_file.open(filename) || _file.size() < sizeof(PackHeader))
+                return;
+            const PackHeader* h = reinterpret_cast<const PackHeader*>(_file.data());
+            if (std::memcmp(h->magic, "SDLXPAK", 8) != 0
+                || h->version != PACK_VERSION
+                || _file.size() < sizeof(PackHeader) + h->count * sizeof(PackEntry))
+                return;
+            _header = h;
+            const PackEntry* entries = reinterpret_cast<const PackEntry*>(h + 1);
+            for (uint32_t i = 0; i < h->count; ++i)
+            {
+                if (entries[i].name[PACK_NAME - 1] == '\0'
+                    && entries[i].offset + entries[i].size <= _file.size())
+                    _entries[entries[i].name] = &entries[i];
+            }
+        }
+        const PackEntry* find(const std::string& name, uint32_t hash) const
+        {
+            std::map<std::string, const PackEntry*>::const_iterator p
+                = _entries.find(name);
+            if (p == _entries.end() || p->second->hash != hash)
+                return NULL;
+            return p->second;
+        }
+        const uint8_t* data(const PackEntry& e) const
+        {
+            return _file.data() + e.offset;
+        }
+        // True if the index of the old pack is exactly index.
+        bool same(const std::vector<PackEntry>& index) const
+        {
+            return _header != NULL && _header->count == index.size()
+                && (index.empty()
+                    || std::memcmp(_header + 1, index.data(),
+                                   index.size() * sizeof(PackEntry)) == 0);
+        }
+        void close()
+        {
+            _file.close();
+        }
+    private:
+        MappedFile _file;
+        const PackHeader* _header;
+        std::map<std::string, const PackEntry*> _entries;
+    };
+
+    //------------------------------------------------------------------------
+    // Decoding
+    //------------------------------------------------------------------------
+
+    // Copies w x h pixels from rows pitch bytes apart into a tight buffer.
+    void copy_pixels(Asset& a, const uint8_t* pixels, int pitch)
+    {
+        const int bpp = SDL_BYTESPERPIXEL(a.entry.format);
+        const int row = a.entry.width * bpp;
+        a.entry.pitch = row;
+        a.bytes.resize(static_cast<size_t>(row) * a.entry.height);
+        for (uint32_t y = 0; y < a.entry.height; ++y)
+            std::memcpy(&a.bytes[y * row], pixels + y * pitch, row);
+    }
+
+    bool decode_image(Asset& a, const Options& o)
+    {
+        SDL_Surface* s = IMG_Load(a.entry.name);
+        if (s == NULL)
+        {
+            std::cout << "Error: Cannot load " << a.entry.name << ": "
+                      << IMG_GetError() << '\n';
+            return false;
+        }
+        SDL_Surface* c = SDL_ConvertSurfaceFormat(s, o.format, 0);
+        SDL_FreeSurface(s);
+        if (c == NULL)
+        {
+            std::cout << "Error: Cannot convert " << a.entry.name << ": "
+                      << SDL_GetError() << '\n';
+            return false;
+        }
+        a.entry.format = o.format;
+        a.entry.width = c->w;
+        a.entry.height = c->h;
+        SDL_LockSurface(c);
+        copy_pixels(a, static_cast<const uint8_t*>(c->pixels), c->pitch);
+        SDL_UnlockSurface(c);
+        SDL_FreeSurface(c);
+        return true;
+    }
+
+    // The audio device is only opened once a sound has to be decoded.
+    bool open_audio(const Options& o)
+    {
+        static int opened = -1;
+        if (opened < 0)
+        {
+            opened = SDL_InitSubSystem(SDL_INIT_AUDIO) == 0
+                && Mix_OpenAudio(o.rate, AUDIO_S16SYS, o.channels, 1024) == 0;
+            if (!opened)
+                std::cout << "Error: Cannot open audio: " << Mix_GetError() << '\n';
+        }
+        return opened == 1;
+    }
+
+    bool decode_sound(Asset& a, const Options& o)
+    {
+        if (!open_audio(o))
+            return false;
+        // Mix_LoadWAV converts the samples to the format of the device.
+        Mix_Chunk* chunk = Mix_LoadWAV(a.entry.name);
+        if (chunk == NULL)
+        {
+            std::cout << "Error: Cannot load " << a.entry.name << ": "
+                      << Mix_GetError() << '\n';
+            return false;
+        }
+        int rate = 0, channels = 0;
+        Uint16 format = 0;
+        Mix_QuerySpec(&rate, &format, &channels);
+        a.entry.format = format;
+        a.entry.width = rate;
+        a.entry.height = channels;
+        a.bytes.assign(chunk->abuf, chunk->abuf + chunk->alen);
+        Mix_FreeChunk(chunk);
+        return true;
+    }
+
+    // Makes the asset for one file, from the old pack if it can.
+    bool load(Asset& a, const MappedFile& source, const OldPack& old,
+              const Options& o, Counts& counts)
+    {
+        const PackEntry* prev = o.force ? NULL : old.find(a.entry.name, a.entry.hash);
+
+        switch (a.entry.type)
+        {
+        case PACK_IMAGE:
+            if (prev != NULL && prev->format == o.format
+                && (prev->type == PACK_IMAGE || prev->type == PACK_REGION))
+            {
+                a.entry.format = prev->format;
+                a.entry.width = prev->width;
+                a.entry.height = prev->height;
+                copy_pixels(a, old.data(*prev), prev->pitch);
+                ++counts.reused;
+                return true;
+            }
+            ++counts.decoded;
+            return decode_image(a, o);
+
+        case PACK_SOUND:
+            if (prev != NULL && prev->type == PACK_SOUND
+                && prev->format == AUDIO_S16SYS
+                && static_cast<int>(prev->width) == o.rate
+                && static_cast<int>(prev->height) == o.channels)
+            {
+                a.entry.format = prev->format;
+                a.entry.width = prev->width;
+                a.entry.height = prev->height;
+                a.data = old.data(*prev);
+                a.size = prev->size;
+                ++counts.reused;
+                return true;
+            }
+            ++counts.decoded;
+            return decode_sound(a, o);
+
+        default:
+            a.data = source.data();
+            a.size = source.size();
+            ++counts.copied;
+            return true;
+        }
+    }
+
+    //------------------------------------------------------------------------
+    // Atlas
+    //------------------------------------------------------------------------
+
+    bool taller(const Asset* a, const Asset* b)
+    {
+        if (a->entry.height != b->entry.height)
+            return a->entry.height > b->entry.height;
+        return std::strcmp(a->entry.name, b->entry.name) < 0;
+    }
+
+    // Packs small images into pages, shelf by shelf, tallest first. Each
+    // image gets a one pixel gap so filtering never picks up a neighbour.
+    // The pages are appended to assets and the images become regions.
+    void build_atlas(std::vector<Asset>& assets, const Options& o)
+    {
+        if (o.atlas <= 0)
+            return;
+
+        std::vector<Asset*> small;
+        for (size_t i = 0; i < assets.size(); ++i)
+        {
+            const PackEntry& e = assets[i].entry;
+            if (e.type == PACK_IMAGE && e.width > 0 && e.height > 0
+                && static_cast<int>(e.width) <= std::min(o.atlas_max, o.atlas)
+                && static_cast<int>(e.height) <= o.atlas_max)
+                small.push_back(&assets[i]);
+        }
+        if (small.size() < 2)
+            return;
+        std::sort(small.begin(), small.end(), taller);
+
+        // Layout
+        std::vector<int> pages(small.size());
+        std::vector<int> heights;
+        int page = 0, x = 0, y = 0, shelf = 0;
+        heights.push_back(0);
+        for (size_t i = 0; i < small.size(); ++i)
+        {
+            PackEntry& e = small[i]->entry;
+            if (x + static_cast<int>(e.width) > o.atlas)
+            {
+                x = 0;
+                y += shelf + 1;
+                shelf = 0;
+            }
+            if (y + static_cast<int>(e.height) > o.atlas)
+            {
+                ++page;
+                heights.push_back(0);
+                x = y = shelf = 0;
+            }
+            e.x = x;
+            e.y = y;
+            pages[i] = page;
+            x += e.width + 1;
+            shelf = std::max(shelf, static_cast<int>(e.height));
+            heights[page] = std::max(heights[page], y + shelf);
+        }
+
+        // Pages
+        const size_t first = assets.size();
+        const int bpp = SDL_BYTESPERPIXEL(o.format);
+        std::vector<Asset> sheets(heights.size());
+        for (size_t p = 0; p < sheets.size(); ++p)
+        {
+            PackEntry& e = sheets[p].entry;
+            std::snprintf(e.name, PACK_NAME, "atlas/%u", static_cast<unsigned>(p));
+            e.type = PACK_IMAGE;
+            e.format = o.format;
+            e.width = o.atlas;
+            e.height = heights[p];
+            e.pitch = o.atlas * bpp;
+            e.hash = 2166136261u;
+            sheets[p].bytes.assign(static_cast<size_t>(e.pitch) * e.height, 0);
+        }
+        for (size_t i = 0; i < small.size(); ++i)
+        {
+            Asset& a = *small[i];
+            Asset& sheet = sheets[pages[i]];
+            const int row = a.entry.width * bpp;
+            for (uint32_t y = 0; y < a.entry.height; ++y)
+                std::memcpy(&sheet.bytes[(a.entry.y + y) * sheet.entry.pitch
+                                         + a.entry.x * bpp],
+                            &a.bytes[y * a.entry.pitch], row);
+            sheet.entry.hash = fnv1a(a.entry.hash, sheet.entry.hash);
+            sheet.entry.hash = fnv1a(a.entry.x, sheet.entry.hash);
+            sheet.entry.hash = fnv1a(a.entry.y, sheet.entry.hash);
+
+            a.entry.type = PACK_REGION;
+            a.entry.atlas = first + pages[i];
+            a.entry.pitch = sheet.entry.pitch;
+            std::vector<uint8_t>().swap(a.bytes);
+        }
+        for (size_t p = 0; p < sheets.size(); ++p)
+            assets.push_back(std::move(sheets[p]));
+    }
+
+    //------------------------------------------------------------------------
+    // Output
+    //------------------------------------------------------------------------
+
+    size_t align(size_t n)
+    {
+        return (n + PACK_ALIGN - 1) / PACK_ALIGN * PACK_ALIGN;
+    }
+
+    std::vector<PackEntry> make_index(const std::vector<Asset>& assets)
+    {
+        std::vector<PackEntry> index(assets.size());
+        size_t offset = align(sizeof(PackHeader) + assets.size() * sizeof(PackEntry));
+        for (size_t i = 0; i < assets.size(); ++i)
+        {
+            index[i] = assets[i].entry;
+            if (index[i].type == PACK_REGION)
+                continue;
+            index[i].offset = offset;
+            index[i].size = assets[i].payload_size();
+            offset = align(offset + index[i].size);
+        }
+        // A region points into its page.
+        for (size_t i = 0; i < index.size(); ++i)
+        {
+            PackEntry& e = index[i];
+            if (e.type != PACK_REGION)
+                continue;
+            const PackEntry& page = index[e.atlas];
+            const int bpp = SDL_BYTESPERPIXEL(e.format);
+            e.offset = page.offset + e.y * page.pitch + e.x * bpp;
+            e.size = (e.height - 1) * page.pitch + e.width * bpp;
+        }
+        return index;
+    }
+
+    bool write(const std::string& filename, const std::vector<PackEntry>& index,
+               const std::vector<Asset>& assets)
+    {
+        FILE* f = std::fopen(filename.c_str(), "wb");
+        if (f == NULL)
+        {
+            std::cout << "Error: Cannot write " << filename << '\n';
+            return false;
+        }
+        PackHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, "SDLXPAK", 8);
+        header.version = PACK_VERSION;
+        header.count = index.size();
+
+        bool ok = std::fwrite(&header, sizeof(header), 1, f) == 1
+            && (index.empty()
+                || std::fwrite(index.data(), sizeof(PackEntry), index.size(), f)
+                   == index.size());
+        size_t at = sizeof(header) + index.size() * sizeof(PackEntry);
+        static const uint8_t zeros[PACK_ALIGN] = { 0 };
+        for (size_t i = 0; ok && i < assets.size(); ++i)
+        {
+            if (index[i].type == PACK_REGION)
+                continue;
+            ok = std::fwrite(zeros, 1, index[i].offset - at, f) == index[i].offset - at
+                && std::fwrite(assets[i].payload(), 1, index[i].size, f) == index[i].size;
+            at = index[i].offset + index[i].size;
+        }
+        ok = std::fclose(f) == 0 && ok;
+        if (!ok)
+            std::cout << "Error: Cannot write " << filename << '\n';
+        return ok;
+    }
+
+    //------------------------------------------------------------------------
+
+    bool parse(int argc, char* argv[], Options& o)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string arg = argv[i];
+            const bool value = i + 1 < argc;
+            if (arg == "--force")
+                o.force = true;
+            else if (arg == "--format" && value)
+            {
+                const std::string f = argv[++i];
+                if (f == "argb8888")
+                    o.format = SDL_PIXELFORMAT_ARGB8888;
+                else if (f == "abgr8888")
+                    o.format = SDL_PIXELFORMAT_ABGR8888;
+                else
+                {
+                    std::cout << "Error: Unknown format " << f << '\n';
+                    return false;
+                }
+            }
+            else if (arg == "--rate" && value)
+                o.rate = std::atoi(argv[++i]);
+            else if (arg == "--channels" && value)
+                o.channels = std::atoi(argv[++i]);
+            else if (arg == "--atlas" && value)
+                o.atlas = std::atoi(argv[++i]);
+            else if (arg == "--atlas-max" && value)
+                o.atlas_max = std::atoi(argv[++i]);
+            else if (arg.compare(0, 2, "--") == 0)
+            {
+                std::cout << "Error: Unknown option " << arg << '\n';
+                return false;
+            }
+            else if (o.output.empty())
+                o.output = arg;
+            else
+                o.dirs.push_back(arg);
+        }
+        if (o.output.empty() || o.dirs.empty())
+        {
+            std::cout << "usage: sdlxpack [options] OUTPUT DIRECTORY...\n";
+            return false;
+        }
+        return true;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    Options o;
+    if (!parse(argc, argv, o))
+        return 2;
+
+    // The audio device is only used to convert samples, never heard.
+    if (SDL_getenv("SDL_AUDIODRIVER") == NULL)
+        SDL_setenv("SDL_AUDIODRIVER", "dummy", 1);
+    if (SDL_Init(0) != 0)
+    {
+        std::cout << "Error: SDL_Init: " << SDL_GetError() << '\n';
+        return 1;
+    }
+
+    std::vector<std::string> files;
+    for (size_t i = 0; i < o.dirs.size(); ++i)
+    {
+        std::vector<std::string> found = list_files(o.dirs[i]);
+        files.insert(files.end(), found.begin(), found.end());
+    }
+    std::sort(files.begin(), files.end());
+
+    OldPack old(o.output);
+    Counts counts;
+    std::vector<MappedFile> sources;
+    std::vector<Asset> assets;
+    sources.reserve(files.size());
+    assets.reserve(files.size());
+    int status = 0;
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+        if (files[i].size() >= static_cast<size_t>(PACK_NAME))
+        {
+            std::cout << "Error: Name too long, skipped " << files[i] << '\n';
+            status = 1;
+            continue;
+        }
+        sources.push_back(MappedFile());
+        if (!sources.back().open(files[i]))
+        {
+            status = 1;
+            continue;
+        }
+
+        Asset a;
+        std::strcpy(a.entry.name, files[i].c_str());
+        a.entry.type = classify(files[i]);
+        a.entry.hash = fnv1a(sources.back().data(), sources.back().size());
+        if (load(a, sources.back(), old, o, counts))
+            assets.push_back(std::move(a));
+        else
+            status = 1;
+    }
+
+    build_atlas(assets, o);
+    const std::vector<PackEntry> index = make_index(assets);
+
+    if (old.same(index))
+    {
+        std::cout << o.output << " is up to date (" << assets.size()
+                  << " assets)\n";
+    }
+    else
+    {
+        const std::string tmp = o.output + ".tmp";
+        if (write(tmp, index, assets))
+        {
+            // Sounds may still be read from the old pack until it is written.
+            old.close();
+            std::remove(o.output.c_str());
+            if (std::rename(tmp.c_str(), o.output.c_str()) != 0)
+            {
+                std::cout << "Error: Cannot replace " << o.output << '\n';
+                status = 1;
+            }
+            else
+                std::cout << o.output << ": " << assets.size() << " assets, "
+                          << counts.decoded << " decoded, " << counts.reused
+                          << " unchanged, " << counts.copied << " copied\n";
+        }
+        else
+            status = 1;
+    }
+
+    Mix_CloseAudio();
+    SDL_Quit();
+    return status;
+}